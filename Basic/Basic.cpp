@@ -5,21 +5,88 @@
  */
 
 #include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <string>
-#include <memory>
+#include <string_view>
 #include "exp.hpp"
 #include "parser.hpp"
 #include "program.hpp"
+#include "statementcache.hpp"
+#include "compiler.hpp"
+#include "vm.hpp"
+#include "threaded.hpp"
+#include "profiler.hpp"
+#include "sampler.hpp"
+#include "input.hpp"
+#include "lexer.hpp"
+#include "output.hpp"
 #include "Utils/error.hpp"
-#include "Utils/tokenScanner.hpp"
 #include "Utils/strlib.hpp"
 
 
 /* Function prototypes */
 
-void processLine(std::string line, Program &program, EvalState &state);
-Statement* parseStatement(const std::string &line);//用于确定当前处理的行对应什么状态
+void processLine(std::string_view line, Program &program, EvalState &state);
+Statement* parseStatement(const std::string &line, Arena &arena);//用于确定当前处理的行对应什么状态
+void runProgram(Program &program, EvalState &state);
+void profileProgram(Program &program, EvalState &state);
+
+/*
+ * Flag: treeWalkMode
+ * ------------------
+ * Set by the --tree-walk option.  RUN then executes the parsed
+ * statements directly instead of compiling the program to bytecode,
+ * which is useful for comparing the two on the Test traces.
+ */
+
+bool treeWalkMode = false;
+
+/*
+ * Flag: threadedMode
+ * ------------------
+ * Set by the --threaded option.  RUN then links the statements into
+ * ThreadedCode and runs that instead of the bytecode.  --tree-walk
+ * takes precedence when both are given.
+ */
+
+bool threadedMode = false;
+
+/*
+ * Flag: jitMode
+ * -------------
+ * Set by the --jit option.  The virtual machine then compiles hot
+ * loops to native code where the platform supports it.
+ */
+
+bool jitMode = false;
+
+/*
+ * Flag: statsMode
+ * ---------------
+ * Set by the --stats option.  RUN in tree-walk mode then counts the
+ * statements it executes in executedStatements, and the total is
+ * printed to stderr when the interpreter exits.  The other engines run
+ * whole programs and do not count them.
+ */
+
+bool statsMode = false;
+
+long long executedStatements = 0;
+
+static void printExitStats() {
+    std::cerr << "STATEMENTS " << executedStatements << std::endl;
+}
+
+/*
+ * Variable: statementCache
+ * ------------------------
+ * Shares one parsed statement between all lines and commands with the
+ * same statement text.  The STATS command prints its hit rate.
+ */
+
+StatementCache statementCache(parseStatement);
+
 /* Main program */
 
 
@@ -38,32 +105,44 @@ Statement* parseStatement(const std::string &line);//用于确定当前处理的
 
 
 
-int main() {
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--tree-walk") treeWalkMode = true;
+        if (std::string(argv[i]) == "--threaded") threadedMode = true;
+        if (std::string(argv[i]) == "--jit") jitMode = true;
+        if (std::string(argv[i]) == "--int64") numericMode = NUMERIC_INT64;
+        if (std::string(argv[i]) == "--stats" && !statsMode) {
+            statsMode = true;
+            std::atexit(printExitStats);
+        }
+        if (std::string(argv[i]) == "--sample" && i + 1 < argc && !Sampler::start(argv[++i])) {
+            std::cerr << "Cannot start sampling to " << argv[i] << std::endl;
+            return 1;
+        }
+    }
     EvalState state;
     Program program;
     //cout << "Stub implementation of BASIC" << endl;
-    while (true) {
+    std::string_view line;
+    while (input().readLine(line)) {
         try {
-            std::string input;
-            getline(std::cin, input);
-            if (input.empty())
+            if (line.empty())
                 continue;
-            processLine(input, program, state);
+            Sampler::line = -1;//采样时不把解析算到上次运行的行上
+            processLine(line, program, state);
         } catch (ErrorException &ex) {
-            std::cout << ex.getMessage() << std::endl;
+            output() << ex.getMessage() << '\n';
+            output().flush();
         }
     }
+    output().flush();
     return 0;
 }
 
-void processLine(std::string line, Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(line);
+void processLine(std::string_view line, Program &program, EvalState &state) {
     if (line.empty()) return;
-    if (isdigit(line[0])) {
-        int i = 0;
+    if (isdigit(line[0])) {//程序行直接存入，不经过 TokenScanner
+        std::size_t i = 0;
         int lineNumber = 0;
         while (i < line.length() && isdigit(line[i])) {
             lineNumber = lineNumber * 10 + (line[i] - '0');
@@ -74,70 +153,158 @@ void processLine(std::string line, Program &program, EvalState &state) {
         }//如果行号之后没有内容
         else {
             while (i < line.length() && isspace(line[i])) ++i;
-            std::string statementLine = line.substr(i);//提取语句部分
-            std::unique_ptr<Statement> stmt;
+            std::string statementLine(line.substr(i));//提取语句部分
             try {
-                stmt.reset(parseStatement(statementLine));
+                CachedStatement *parsed = statementCache.acquire(statementLine);//相同的语句只解析一次
                 program.addSourceLine(lineNumber, statementLine);
-                program.setParsedStatement(lineNumber, stmt.release());
+                program.setParsedStatement(lineNumber, parsed);
             } catch (const ErrorException &ex) {
-                std::cout << ex.getMessage() << '\n';//输出错误信息
+                output() << ex.getMessage() << '\n';//输出错误信息
+                output().flush();
             }
         }
         return;
     }
-    std::string command = scanner.nextToken();//确定指令内容
+    std::string text(line);//line 只在下一次读入前有效
+    Lexer lexer(text);
+    std::string_view command = lexer.getText(lexer.peek());//确定指令内容
     if (command == "RUN") {
-        int currentLine = program.getFirstLineNumber();//找到第一行
-        program.setCurrentLineNumber(currentLine);
-        while (currentLine != -1) {
-            Statement *stmt = program.getParsedStatement(currentLine);
-            if (stmt == nullptr) {
-                error("SYNTAX ERROR");
-            }//没有内容
-            stmt->execute(state, program);
-            currentLine = program.getCurrentLineNumber();
-            if (currentLine != -1 && currentLine == program.getNextLineNumber(currentLine)) {
-                currentLine = program.getNextLineNumber(currentLine);
-                program.setCurrentLineNumber(currentLine);
-            }
-        }
+        runProgram(program, state);
+    }
+    else if (command == "PROFILE") {
+        profileProgram(program, state);
     }
     else if (command == "LIST") {
         program.printAllLines();
     }
     else if (command == "CLEAR") {
         program.clear();
-        state = EvalState();
+        state.Clear();
+        statementCache.purge();
     }
     else if (command == "QUIT") {
+        output().flush();
         exit(0);
     }
     else if (command == "HELP") {
-        std::cout << "You are running the BASIC program.\n";
+        output() << "You are running the BASIC program.\n";
+    }
+    else if (command == "STATS") {
+        statementCache.printStats();
     }
     else {
-        std::unique_ptr<Statement> stmt;//智能指针，不需要delete
+        CachedStatement *parsed = nullptr;
         try {
-            stmt.reset(parseStatement(line));
-            stmt->execute(state, program);
+            parsed = statementCache.acquire(text);
+            SamplerPhase phase(PHASE_EXECUTE);
+            parsed->stmt->execute(state, program);
         } catch (const ErrorException &ex) {
-            std::cout << ex.getMessage() << std::endl;
+            output() << ex.getMessage() << '\n';
+            output().flush();
         }
+        StatementCache::release(parsed);
     }
 }
 
-Statement* parseStatement(const std::string &line) {
-    TokenScanner scanner(line);
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    std::string command = scanner.nextToken();
-    if (command == "REM") return new REM(line);
-    if (command == "LET") return new LET(line);
-    if (command == "PRINT") return new PRINT(line);
-    if (command == "INPUT") return new INPUT(line);
-    if (command == "END") return new END(line);
-    if (command == "GOTO") return new GOTO(line);
-    if (command == "IF") return new IF(line);
-    throw ErrorException("Unknown command");
+/*
+ * Implementation notes: parseStatement
+ * ------------------------------------
+ * The line is tokenized once into a lexer whose token buffer is kept
+ * between calls, and the statement constructor reads its tokens from
+ * there, starting with the keyword.
+ */
+
+Statement* parseStatement(const std::string &line, Arena &arena) {
+    SamplerPhase phase(PHASE_PARSE);
+    static Lexer lexer;
+    lexer.setInput(line);
+    std::string_view command = lexer.getText(lexer.peek());
+    if (command == "REM") return arena.make<REM>(lexer, arena);
+    if (command == "LET") return arena.make<LET>(lexer, arena);
+    if (command == "PRINT") return arena.make<PRINT>(lexer, arena);
+    if (command == "INPUT") return arena.make<INPUT>(lexer, arena);
+    if (command == "DIM") return arena.make<DIM>(lexer, arena);
+    if (command == "END") return arena.make<END>(lexer, arena);
+    if (command == "GOTO") return arena.make<GOTO>(lexer, arena);
+    if (command == "IF") return arena.make<IF>(lexer, arena);
+    error("SYNTAX ERROR");
+    return nullptr;
+}
+
+/*
+ * Function: runStatements
+ * Usage: runStatements<false, false>(program, state, nullptr);
+ * ------------------------------------------------------------
+ * Executes the stored program one statement at a time from its first
+ * line.  The profiling instance brackets each statement with the
+ * profiler and the counting one adds to executedStatements; the
+ * instance with neither compiles to the plain loop.
+ */
+
+template <bool profiling, bool counting>
+static void runStatements(Program &program, EvalState &state, Profiler *profiler) {
+    SamplerPhase phase(PHASE_EXECUTE);
+    program.setCurrentLineNumber(program.getFirstLineNumber());//找到第一行
+    while (Statement *stmt = program.getCurrentStatement()) {
+        if (counting) ++executedStatements;
+        if (Sampler::enabled) Sampler::line = program.getCurrentLineNumber();
+        if (profiling) profiler->enterLine(program.getCurrentLineNumber());
+        stmt->execute(state, program);
+        if (profiling) profiler->leaveLine();
+    }
+}
+
+/*
+ * Function: runProgram
+ * Usage: runProgram(program, state);
+ * ----------------------------------
+ * Runs the stored program from its first line.  By default the whole
+ * program is compiled to bytecode and run by the virtual machine; in
+ * tree-walk mode each statement's execute method is called in turn,
+ * and in threaded mode the statements run as ThreadedCode.
+ */
+
+void runProgram(Program &program, EvalState &state) {
+    if (treeWalkMode) {
+        if (statsMode) {
+            runStatements<false, true>(program, state, nullptr);
+        } else {
+            runStatements<false, false>(program, state, nullptr);
+        }
+    } else if (threadedMode) {
+        ThreadedCode code(program);
+        code.run(state);
+    } else {
+        Compiler compiler;
+        VirtualMachine vm;
+        vm.setJitEnabled(jitMode);
+        Bytecode bytecode;
+        {
+            SamplerPhase phase(PHASE_COMPILE);
+            bytecode = compiler.compile(program);
+        }
+        vm.run(bytecode, state);
+    }
+    output().flush();
+}
+
+/*
+ * Function: profileProgram
+ * Usage: profileProgram(program, state);
+ * --------------------------------------
+ * Implements PROFILE: runs the program like RUN, but one statement at
+ * a time so that every line can be timed, then prints the profile.  An
+ * error stops the run as usual, and the profile up to that point is
+ * printed after the message.
+ */
+
+void profileProgram(Program &program, EvalState &state) {
+    Profiler profiler;
+    try {
+        runStatements<true, false>(program, state, &profiler);
+    } catch (const ErrorException &ex) {
+        output() << ex.getMessage() << '\n';
+    }
+    profiler.printReport();
+    output().flush();
 }
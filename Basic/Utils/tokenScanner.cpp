@@ -34,13 +34,6 @@ TokenScanner::~TokenScanner() {
         delete pre;
         pre = savedTokens;
     }
-    //delete operators chain
-    StringCell *p = operators;
-    while (operators) {
-        operators = operators->link;
-        delete p;
-        p = operators;
-    }
 }
 
 void TokenScanner::setInput(std::string str) {
@@ -108,17 +101,7 @@ std::string TokenScanner::nextToken() {
             isp->unget();
             return scanWord();
         }
-        std::string op = std::string(1, ch);
-        while (isOperatorPrefix(op)) {
-            ch = isp->get();
-            if (ch == EOF) break;
-            op += ch;
-        }
-        while (op.length() > 1 && !isOperator(op)) {
-            isp->unget();
-            op.erase(op.length() - 1, 1);
-        }
-        return op;
+        return scanOperator(ch);
     }
 }
 
@@ -146,14 +129,23 @@ void TokenScanner::scanStrings() {
 }
 
 void TokenScanner::addWordCharacters(std::string str) {
-    wordChars += str;
+    for (char ch : str) {
+        charClass[(unsigned char) ch] |= WORD_CLASS;
+    }
 }
 
 void TokenScanner::addOperator(std::string op) {
-    StringCell *cp = new StringCell;
-    cp->str = op;
-    cp->link = operators;
-    operators = cp;
+    int node = 0;
+    for (char ch : op) {
+        int child = findOperatorChild(node, ch);
+        if (child < 0) {
+            child = int(operatorTrie.size());
+            operatorTrie[node].children.push_back(std::make_pair(ch, child));
+            operatorTrie.emplace_back();
+        }
+        node = child;
+    }
+    if (node != 0) operatorTrie[node].isOperator = true;
 }
 
 int TokenScanner::getPosition() const {
@@ -166,7 +158,7 @@ int TokenScanner::getPosition() const {
 }
 
 bool TokenScanner::isWordCharacter(char ch) const {
-    return isalnum(ch) || wordChars.find(ch) != std::string::npos;
+    return (charClass[(unsigned char) ch] & WORD_CLASS) != 0;
 };
 
 void TokenScanner::verifyToken(std::string expected) {
@@ -278,7 +270,12 @@ void TokenScanner::initScanner() {
     ignoreCommentsFlag = false;
     scanNumbersFlag = false;
     scanStringsFlag = false;
-    operators = nullptr;
+    for (int ch = 0; ch < 256; ch++) {
+        charClass[ch] = 0;
+        if (isalnum(ch)) charClass[ch] |= WORD_CLASS;
+        if (isspace(ch)) charClass[ch] |= SPACE_CLASS;
+    }
+    operatorTrie.assign(1, OperatorNode());
 }
 
 /*
@@ -292,7 +289,7 @@ void TokenScanner::skipSpaces() {
     while (true) {
         int ch = isp->get();
         if (ch == EOF) return;
-        if (!isspace(ch)) {
+        if (!(charClass[ch] & SPACE_CLASS)) {
             isp->unget();
             return;
         }
@@ -425,24 +422,36 @@ std::string TokenScanner::scanString() {
 }
 
 /*
- * Implementation notes: isOperator, isOperatorPrefix
- * --------------------------------------------------
- * These methods search the list of operators and return true if the
- * specified operator is either in the list or a prefix of an operator
- * in the list, respectively.  This code could be made considerably more
- * efficient by implementing operators as a trie.
+ * Implementation notes: scanOperator, findOperatorChild
+ * -----------------------------------------------------
+ * scanOperator follows the operator trie from the character ch for as
+ * long as the input continues some defined operator, remembering the
+ * longest complete operator seen on the way.  The characters read past
+ * that operator are pushed back, and a character that starts no longer
+ * operator is returned as a token of its own.
  */
 
-bool TokenScanner::isOperator(std::string op) {
-    for (StringCell *cp = operators; cp != nullptr; cp = cp->link) {
-        if (op == cp->str) return true;
+std::string TokenScanner::scanOperator(int ch) {
+    std::string op = std::string(1, ch);
+    int node = findOperatorChild(0, char(ch));
+    size_t length = 1;
+    while (node >= 0) {
+        if (operatorTrie[node].isOperator) length = op.length();
+        ch = isp->get();
+        if (ch == EOF) break;
+        op += char(ch);
+        node = findOperatorChild(node, char(ch));
+    }
+    while (op.length() > length) {
+        isp->unget();
+        op.erase(op.length() - 1, 1);
     }
-    return false;
+    return op;
 }
 
-bool TokenScanner::isOperatorPrefix(std::string op) {
-    for (StringCell *cp = operators; cp != nullptr; cp = cp->link) {
-        if (startsWith(cp->str, op)) return true;
+int TokenScanner::findOperatorChild(int node, char ch) const {
+    for (const std::pair<char, int> &child : operatorTrie[node].children) {
+        if (child.first == ch) return child.second;
     }
-    return false;
+    return -1;
 }
@@ -17,6 +17,8 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 /*
  * Type: TokenType
@@ -310,10 +312,10 @@ private:
  * Private type: StringCell
  * ------------------------
  * This type is used to construct linked lists of cells, which are used
- * to represent both the stack of saved tokens and the set of defined
- * operators.  These types cannot use the Stack and Lexicon classes
- * directly because tokenscanner.h is an extremely low-level interface,
- * and doing so would create circular dependencies in the .h files.
+ * to represent the stack of saved tokens.  These types cannot use the
+ * Stack class directly because tokenscanner.h is an extremely low-level
+ * interface, and doing so would create circular dependencies in the .h
+ * files.
  */
 
     struct StringCell {
@@ -321,6 +323,30 @@ private:
         StringCell *link;
     };
 
+/*
+ * Private type: OperatorNode
+ * --------------------------
+ * A node of the operator trie.  The path from the root to a node
+ * spells an operator prefix; isOperator marks the nodes that end a
+ * complete operator.  Node 0 is the root, and children are few enough
+ * that a small list of (character, node index) pairs is searched.
+ */
+
+    struct OperatorNode {
+        std::vector<std::pair<char, int>> children;
+        bool isOperator = false;
+    };
+
+/*
+ * Private constants: character classes
+ * ------------------------------------
+ * Bits stored for each character in charClass, so that classifying a
+ * character is a single table lookup.
+ */
+
+    static const unsigned char WORD_CLASS = 1;
+    static const unsigned char SPACE_CLASS = 2;
+
     enum NumberScannerState {
         INITIAL_STATE,
         BEFORE_DECIMAL_POINT,
@@ -337,9 +363,9 @@ private:
     bool ignoreCommentsFlag;         /* Scanner ignores comments     */
     bool scanNumbersFlag;            /* Scanner parses numbers       */
     bool scanStringsFlag;            /* Scanner parses strings       */
-    std::string wordChars;           /* Additional word characters   */
+    unsigned char charClass[256];    /* Class bits for each character */
     StringCell *savedTokens = nullptr;         /* Stack of saved tokens        */
-    StringCell *operators = nullptr;           /* List of multichar operators  */
+    std::vector<OperatorNode> operatorTrie;    /* Trie of multichar operators  */
 
 /* Private method prototypes */
 
@@ -353,9 +379,9 @@ private:
 
     std::string scanString();
 
-    bool isOperator(std::string op);
+    int findOperatorChild(int node, char ch) const;
 
-    bool isOperatorPrefix(std::string op);
+    std::string scanOperator(int ch);
 
 };
 
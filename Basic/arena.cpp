@@ -0,0 +1,71 @@
+/*
+ * File: arena.cpp
+ * ---------------
+ * Implements the arena.hpp interface.
+ */
+
+#include <cstdlib>
+#include "arena.hpp"
+
+/*
+ * Implementation notes: chunk sizes
+ * ---------------------------------
+ * Most program lines need only a few hundred bytes, so the first chunk
+ * is small and each further chunk doubles in size up to a limit.  A
+ * request that does not fit in a normal chunk gets one of its own.
+ */
+
+static const std::size_t FIRST_CHUNK_SIZE = 256;
+static const std::size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+Arena::Arena() : chunks(nullptr), ptr(nullptr), limit(nullptr), finalizers(nullptr),
+                 nextChunkSize(FIRST_CHUNK_SIZE), allocated(0) { }
+
+Arena::~Arena() {
+    release();
+}
+
+void *Arena::allocate(std::size_t size, std::size_t align) {
+    std::size_t padding = (align - reinterpret_cast<std::size_t>(ptr) % align) % align;
+    if (ptr == nullptr || size + padding > std::size_t(limit - ptr)) {
+        addChunk(size + align);
+        padding = (align - reinterpret_cast<std::size_t>(ptr) % align) % align;
+    }
+    char *result = ptr + padding;
+    ptr = result + size;
+    allocated += size;
+    return result;
+}
+
+void Arena::release() {
+    while (finalizers != nullptr) {
+        Finalizer *finalizer = finalizers;
+        finalizers = finalizer->next;
+        finalizer->destroy(finalizer->object);
+    }
+    while (chunks != nullptr) {
+        Chunk *chunk = chunks;
+        chunks = chunk->next;
+        std::free(chunk);
+    }
+    ptr = limit = nullptr;
+    nextChunkSize = FIRST_CHUNK_SIZE;
+    allocated = 0;
+}
+
+std::size_t Arena::bytesAllocated() const {
+    return allocated;
+}
+
+void Arena::addChunk(std::size_t minimum) {
+    std::size_t size = nextChunkSize;
+    if (size < minimum + sizeof(Chunk)) size = minimum + sizeof(Chunk);
+    Chunk *chunk = static_cast<Chunk *>(std::malloc(size));
+    if (chunk == nullptr) throw std::bad_alloc();
+    chunk->next = chunks;
+    chunk->size = size;
+    chunks = chunk;
+    ptr = reinterpret_cast<char *>(chunk) + sizeof(Chunk);
+    limit = reinterpret_cast<char *>(chunk) + size;
+    if (nextChunkSize < MAX_CHUNK_SIZE) nextChunkSize *= 2;
+}
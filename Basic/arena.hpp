@@ -0,0 +1,148 @@
+/*
+ * File: arena.hpp
+ * ---------------
+ * This interface exports the Arena class, a bump allocator that owns
+ * the parsed form of a program line: its Statement and every
+ * Expression node below it.
+ */
+
+#ifndef _arena_h
+#define _arena_h
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Class: Arena
+ * ------------
+ * Objects are carved out of large chunks by advancing a pointer, and
+ * are never freed one at a time.  Destroying the arena (or calling
+ * release) runs the destructors of the objects made with make, in
+ * reverse order, and returns all of its chunks at once.  This means a
+ * parse that fails halfway leaves nothing to clean up: the partial
+ * tree goes away with the arena.
+ */
+
+class Arena {
+
+public:
+
+/*
+ * Constructor: Arena
+ * Usage: Arena arena;
+ * -------------------
+ * Creates an empty arena.  No memory is allocated until the first
+ * object is made.
+ */
+
+    Arena();
+
+/*
+ * Destructor: ~Arena
+ * ------------------
+ * Destroys every object in the arena and frees its memory.
+ */
+
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+
+    Arena &operator=(const Arena &) = delete;
+
+/*
+ * Method: make
+ * Usage: T *obj = arena.make<T>(args...);
+ * ---------------------------------------
+ * Constructs a T in the arena from the given arguments.  If T has a
+ * destructor, it is run when the arena is released.
+ */
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args);
+
+/*
+ * Method: allocate
+ * Usage: void *memory = arena.allocate(size, align);
+ * --------------------------------------------------
+ * Returns size bytes of raw storage with the requested alignment.
+ */
+
+    void *allocate(std::size_t size, std::size_t align);
+
+/*
+ * Method: release
+ * Usage: arena.release();
+ * -----------------------
+ * Destroys every object and frees all memory, leaving the arena
+ * empty and ready for reuse.
+ */
+
+    void release();
+
+/*
+ * Method: bytesAllocated
+ * Usage: std::size_t bytes = arena.bytesAllocated();
+ * --------------------------------------------------
+ * Returns the number of bytes handed out since the arena was last
+ * released.
+ */
+
+    std::size_t bytesAllocated() const;
+
+private:
+
+/*
+ * Private types: Chunk, Finalizer
+ * -------------------------------
+ * Chunks form a list of the blocks obtained from the system.  Each
+ * object with a destructor gets a Finalizer record, itself stored in
+ * the arena, which remembers how to destroy it.
+ */
+
+    struct Chunk {
+        Chunk *next;
+        std::size_t size;
+    };
+
+    struct Finalizer {
+        void *object;
+        void (*destroy)(void *);
+        Finalizer *next;
+    };
+
+    Chunk *chunks;              /* Most recently allocated chunk first */
+    char *ptr;                  /* Next free byte in the current chunk */
+    char *limit;                /* End of the current chunk            */
+    Finalizer *finalizers;      /* Most recently made object first     */
+    std::size_t nextChunkSize;  /* Size of the next chunk to allocate  */
+    std::size_t allocated;      /* Bytes handed out                    */
+
+    void addChunk(std::size_t minimum);
+
+    template <typename T>
+    static void destroy(void *object);
+
+};
+
+template <typename T, typename... Args>
+T *Arena::make(Args &&...args) {
+    void *memory = allocate(sizeof(T), alignof(T));
+    T *object = new (memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+        Finalizer *finalizer = new (allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer;
+        finalizer->object = object;
+        finalizer->destroy = &Arena::destroy<T>;
+        finalizer->next = finalizers;
+        finalizers = finalizer;
+    }
+    return object;
+}
+
+template <typename T>
+void Arena::destroy(void *object) {
+    static_cast<T *>(object)->~T();
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * File: bytecode.hpp
+ * ------------------
+ * This interface defines the flat instruction format that a whole
+ * BASIC program is compiled into before it is run by the virtual
+ * machine in vm.hpp.
+ */
+
+#ifndef _bytecode_h
+#define _bytecode_h
+
+#include <string>
+#include <vector>
+#include "numeric.hpp"
+
+/*
+ * Type: OpCode
+ * ------------
+ * The operations understood by the virtual machine.  Expressions are
+ * compiled to stack operations; statements to stores, I/O and jumps
+ * whose operands are already resolved to instruction offsets.
+ *
+ *   OP_PUSH      push the constant operand
+ *   OP_PUSH_WIDE push constants[operand], for a constant outside the
+ *                range of int in the 64-bit numeric mode
+ *   OP_LOAD      push the variable in slot operand
+ *   OP_STORE     pop a value into the variable in slot operand
+ *   OP_DUP       duplicate the top of the stack
+ *   OP_LOAD_ELEMENT   pop a subscript, push that element of the
+ *                     array in slot operand
+ *   OP_STORE_ELEMENT  pop a value and a subscript, store the value
+ *                     in that element of the array in slot operand
+ *   OP_DIM       pop a bound and dimension the array in slot operand
+ *   OP_ADD ...   pop rhs and lhs, push lhs op rhs
+ *   OP_PRINT     pop a value and print it
+ *   OP_INPUT     prompt for a value and store it in slot operand
+ *   OP_JUMP      continue at instruction operand
+ *   OP_JUMP_LT   pop rhs and lhs, jump to operand if lhs < rhs
+ *   OP_JUMP_GT   pop rhs and lhs, jump to operand if lhs > rhs
+ *   OP_JUMP_EQ   pop rhs and lhs, jump to operand if lhs == rhs
+ *   OP_ERROR     raise the error messages[operand]
+ *   OP_HALT      stop the program
+ *
+ * The remaining opcodes are superinstructions for the statements that
+ * dominate loops.  Their operands do not fit in one int, so operand
+ * is an index into the fused table of the Bytecode (f below):
+ *
+ *   OP_INC              f.slot += f.step
+ *   OP_JUMP_LT_CONST    jump to f.target if f.lhs < the constant f.rhs
+ *   OP_JUMP_LT_VAR      jump to f.target if f.lhs < the variable f.rhs
+ *   OP_INC_JUMP_LT_...  OP_INC followed by the matching jump
+ *
+ * and likewise for GT and EQ.  f.lhs, and f.rhs in the VAR forms, are
+ * variable slots, which raise VARIABLE NOT DEFINED like OP_LOAD.
+ * f.step and the constant f.rhs are always in the range of int.
+ */
+
+enum OpCode {
+    OP_PUSH, OP_PUSH_WIDE, OP_LOAD, OP_STORE, OP_DUP,
+    OP_LOAD_ELEMENT, OP_STORE_ELEMENT, OP_DIM,
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+    OP_PRINT, OP_INPUT,
+    OP_JUMP, OP_JUMP_LT, OP_JUMP_GT, OP_JUMP_EQ,
+    OP_ERROR, OP_HALT,
+    OP_INC,
+    OP_JUMP_LT_CONST, OP_JUMP_GT_CONST, OP_JUMP_EQ_CONST,
+    OP_JUMP_LT_VAR, OP_JUMP_GT_VAR, OP_JUMP_EQ_VAR,
+    OP_INC_JUMP_LT_CONST, OP_INC_JUMP_GT_CONST, OP_INC_JUMP_EQ_CONST,
+    OP_INC_JUMP_LT_VAR, OP_INC_JUMP_GT_VAR, OP_INC_JUMP_EQ_VAR
+};
+
+/*
+ * Type: Instruction
+ * -----------------
+ * A single instruction: an opcode and its integer operand, whose
+ * meaning depends on the opcode.
+ */
+
+struct Instruction {
+    OpCode op;
+    int operand;
+};
+
+/*
+ * Type: FusedOperands
+ * -------------------
+ * The operands of a superinstruction.  Each instruction uses only the
+ * fields that its opcode mentions above.
+ */
+
+struct FusedOperands {
+    int slot;
+    int step;
+    int lhs;
+    int rhs;
+    int target;
+};
+
+/*
+ * Type: Bytecode
+ * --------------
+ * The compiled form of a whole program.  The code array always ends
+ * in OP_HALT, and maxStack is the deepest the operand stack can get
+ * while running it.  lines maps each instruction back to its source
+ * line for the sampling profiler.
+ */
+
+struct Bytecode {
+    std::vector<Instruction> code;
+    std::vector<std::string> messages;  /* Errors raised by OP_ERROR   */
+    std::vector<FusedOperands> fused;   /* Superinstruction operands   */
+    std::vector<Value> constants;       /* Operands of OP_PUSH_WIDE    */
+    std::vector<int> lines;             /* BASIC line of each instruction, -1 for none */
+    int maxStack = 0;
+};
+
+/*
+ * Function: isFused
+ * Usage: if (isFused(op)) ...
+ * ---------------------------
+ * Returns true if op is a superinstruction, whose operand indexes the
+ * fused table.
+ */
+
+inline bool isFused(OpCode op) {
+    return op >= OP_INC;
+}
+
+#endif
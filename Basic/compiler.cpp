@@ -0,0 +1,257 @@
+/*
+ * File: compiler.cpp
+ * ------------------
+ * Implements the compiler.hpp interface.
+ */
+
+#include <limits>
+#include "compiler.hpp"
+#include "program.hpp"
+
+
+static bool fitsInt(Value value) {
+    return value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max();
+}
+
+Bytecode Compiler::compile(Program &program) {
+    bytecode = Bytecode();
+    lineStarts.clear();
+    jumps.clear();
+    depth = 0;
+    jumpTargets.clear();
+    pendingIncrement = -1;
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        int target = program.getParsedStatement(line)->getTargetLine();
+        if (target != -1) jumpTargets.insert(target);
+    }
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        int start = int(bytecode.code.size());
+        lineStarts[line] = start;
+        currentLine = line;
+        program.getParsedStatement(line)->compile(*this);
+        bool onlyIncrement = int(bytecode.code.size()) == start + 1 && bytecode.code[start].op == OP_INC;
+        pendingIncrement = onlyIncrement ? start : -1;
+    }
+    currentLine = -1;
+    emit(OP_HALT);
+    int lineError = -1;
+    for (const auto &jump : jumps) {
+        int offset;
+        auto it = lineStarts.find(jump.second);
+        if (it != lineStarts.end()) {
+            offset = it->second;
+        } else {
+            if (lineError == -1) {
+                lineError = int(bytecode.code.size());
+                emitError("LINE NUMBER ERROR");
+            }
+            offset = lineError;
+        }
+        Instruction &ins = bytecode.code[jump.first];
+        if (isFused(ins.op)) {
+            bytecode.fused[ins.operand].target = offset;
+        } else {
+            ins.operand = offset;
+        }
+    }
+    return std::move(bytecode);
+}
+
+/*
+ * Implementation notes: compileExp
+ * --------------------------------
+ * The code follows CompoundExp::eval exactly: the left operand is
+ * evaluated before the right one, and the errors that eval raises
+ * for a malformed assignment become OP_ERROR instructions so they
+ * are still reported only when the expression is evaluated.  The
+ * OP_PUSH after such an error is never reached but keeps the stack
+ * depth bookkeeping consistent.
+ */
+
+void Compiler::compileExp(Expression *exp) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            emitConstant(((ConstantExp *) exp)->getValue());
+            return;
+        case IDENTIFIER:
+            emit(OP_LOAD, ((IdentifierExp *) exp)->getSlot());
+            return;
+        case ARRAY:
+            compileExp(((ArrayExp *) exp)->getIndex());
+            emit(OP_LOAD_ELEMENT, ((ArrayExp *) exp)->getSlot());
+            return;
+        case COMPOUND:
+            break;
+    }
+    CompoundExp *compound = (CompoundExp *) exp;
+    Operator op = compound->getOp();
+    Expression *lhs = compound->getLHS();
+    Expression *rhs = compound->getRHS();
+    if (op == ASSIGN) {
+        static const int letSlot = EvalState::getSlot("LET");
+        if (lhs->getType() != IDENTIFIER) {
+            emitError("Illegal variable in assignment");
+            emit(OP_PUSH, 0);
+            return;
+        }
+        if (((IdentifierExp *) lhs)->getSlot() == letSlot) {
+            emitError("SYNTAX ERROR");
+            emit(OP_PUSH, 0);
+            return;
+        }
+        compileExp(rhs);
+        emit(OP_DUP);
+        emit(OP_STORE, ((IdentifierExp *) lhs)->getSlot());
+        return;
+    }
+    compileExp(lhs);
+    compileExp(rhs);
+    switch (op) {
+        case ADD: emit(OP_ADD); break;
+        case SUBTRACT: emit(OP_SUB); break;
+        case MULTIPLY: emit(OP_MUL); break;
+        case DIVIDE: emit(OP_DIV); break;
+        default: break;
+    }
+}
+
+/*
+ * Implementation notes: compileAssignment
+ * ---------------------------------------
+ * LET I = I + k, LET I = k + I and LET I = I - k all become OP_INC
+ * when k and -k fit in an int.  The constant is always evaluated
+ * without error, so moving it ahead of the load of I does not change
+ * which error a run reports.
+ */
+
+void Compiler::compileAssignment(int slot, Expression *exp) {
+    if (exp->getType() == COMPOUND) {
+        CompoundExp *compound = (CompoundExp *) exp;
+        Expression *lhs = compound->getLHS();
+        Expression *rhs = compound->getRHS();
+        Operator op = compound->getOp();
+        if (op == ADD && rhs->getType() == IDENTIFIER && lhs->getType() == CONSTANT) {
+            std::swap(lhs, rhs);
+        }
+        bool isSelf = lhs->getType() == IDENTIFIER && ((IdentifierExp *) lhs)->getSlot() == slot;
+        if (isSelf && rhs->getType() == CONSTANT && (op == ADD || op == SUBTRACT)) {
+            Value step = ((ConstantExp *) rhs)->getValue();
+            if (step > std::numeric_limits<int>::min() && step <= std::numeric_limits<int>::max()) {
+                emitFused(OP_INC, FusedOperands{slot, int(op == ADD ? step : -step), 0, 0, -1});
+                return;
+            }
+        }
+    }
+    compileExp(exp);
+    emit(OP_STORE, slot);
+}
+
+/*
+ * Implementation notes: compileCondition
+ * --------------------------------------
+ * A constant on the left is moved to the right by mirroring the
+ * relation.  A constant that does not fit in an int is compared on
+ * the stack.  The fused opcodes come in the order LT, GT, EQ, first
+ * for a constant and then for a variable, with the OP_INC_ forms six
+ * places after the plain ones, so the opcode is found by arithmetic.
+ */
+
+void Compiler::compileCondition(char op, Expression *lhs, Expression *rhs, int lineNumber) {
+    if (lhs->getType() == CONSTANT && rhs->getType() == IDENTIFIER) {
+        std::swap(lhs, rhs);
+        op = op == '<' ? '>' : op == '>' ? '<' : op;
+    }
+    bool narrow = rhs->getType() != CONSTANT || fitsInt(((ConstantExp *) rhs)->getValue());
+    bool leaf = rhs->getType() == IDENTIFIER || rhs->getType() == CONSTANT;
+    if (lhs->getType() != IDENTIFIER || !leaf || !narrow) {
+        compileExp(lhs);
+        compileExp(rhs);
+        emitJump(op == '<' ? OP_JUMP_LT : op == '>' ? OP_JUMP_GT : OP_JUMP_EQ, lineNumber);
+        return;
+    }
+    bool isVariable = rhs->getType() == IDENTIFIER;
+    int lhsSlot = ((IdentifierExp *) lhs)->getSlot();
+    int rhsValue = isVariable ? ((IdentifierExp *) rhs)->getSlot() : int(((ConstantExp *) rhs)->getValue());
+    int relation = op == '<' ? 0 : op == '>' ? 1 : 2;
+    OpCode jump = OpCode(OP_JUMP_LT_CONST + relation + (isVariable ? 3 : 0));
+    if (pendingIncrement != -1 && jumpTargets.count(currentLine) == 0) {
+        Instruction &increment = bytecode.code[pendingIncrement];
+        FusedOperands &operands = bytecode.fused[increment.operand];
+        operands.lhs = lhsSlot;
+        operands.rhs = rhsValue;
+        increment.op = OpCode(jump + 6);
+        jumps.emplace_back(pendingIncrement, lineNumber);
+        pendingIncrement = -1;
+        return;
+    }
+    int index = emitFused(jump, FusedOperands{0, 0, lhsSlot, rhsValue, -1});
+    jumps.emplace_back(index, lineNumber);
+}
+
+void Compiler::emit(OpCode op, int operand) {
+    bytecode.code.push_back({op, operand});
+    bytecode.lines.push_back(currentLine);
+    adjustDepth(op);
+}
+
+void Compiler::emitConstant(Value value) {
+    if (fitsInt(value)) {
+        emit(OP_PUSH, int(value));
+    } else {
+        emit(OP_PUSH_WIDE, int(bytecode.constants.size()));
+        bytecode.constants.push_back(value);
+    }
+}
+
+void Compiler::emitJump(OpCode op, int lineNumber) {
+    jumps.emplace_back(int(bytecode.code.size()), lineNumber);
+    emit(op, -1);
+}
+
+void Compiler::emitError(const std::string &message) {
+    emit(OP_ERROR, int(bytecode.messages.size()));
+    bytecode.messages.push_back(message);
+}
+
+int Compiler::emitFused(OpCode op, const FusedOperands &operands) {
+    int index = int(bytecode.code.size());
+    emit(op, int(bytecode.fused.size()));
+    bytecode.fused.push_back(operands);
+    return index;
+}
+
+/*
+ * Implementation notes: adjustDepth
+ * ---------------------------------
+ * Tracks how deep the operand stack gets so that the virtual machine
+ * can allocate it once before running.
+ */
+
+void Compiler::adjustDepth(OpCode op) {
+    switch (op) {
+        case OP_PUSH:
+        case OP_PUSH_WIDE:
+        case OP_LOAD:
+        case OP_DUP:
+            ++depth;
+            break;
+        case OP_STORE:
+        case OP_DIM:
+        case OP_PRINT:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            --depth;
+            break;
+        case OP_STORE_ELEMENT:
+        case OP_JUMP_LT:
+        case OP_JUMP_GT:
+        case OP_JUMP_EQ:
+            depth -= 2;
+            break;
+        default:
+            break;
+    }
+    if (depth > bytecode.maxStack) bytecode.maxStack = depth;
+}
@@ -0,0 +1,109 @@
+/*
+ * File: compiler.hpp
+ * ------------------
+ * This interface exports the Compiler class, which turns the parsed
+ * statements of a Program into a Bytecode array for the virtual
+ * machine.
+ */
+
+#ifndef _compiler_h
+#define _compiler_h
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "bytecode.hpp"
+#include "exp.hpp"
+
+class Program;
+
+/*
+ * Class: Compiler
+ * ---------------
+ * The compiler walks the program in line order and asks each
+ * statement to compile itself through the emit methods below.
+ * Jumps are recorded by line number and patched to instruction
+ * offsets once every line has been placed; a jump to a line that
+ * does not exist is sent to an OP_ERROR instruction that raises
+ * LINE NUMBER ERROR, so the error still appears only when the jump
+ * is taken.
+ */
+
+class Compiler {
+
+public:
+
+/*
+ * Method: compile
+ * Usage: Bytecode code = compiler.compile(program);
+ * -------------------------------------------------
+ * Compiles every line of the program into a single bytecode array.
+ */
+
+    Bytecode compile(Program &program);
+
+/*
+ * Method: compileExp
+ * Usage: compiler.compileExp(exp);
+ * --------------------------------
+ * Emits the stack code that leaves the value of exp on the stack.
+ */
+
+    void compileExp(Expression *exp);
+
+/*
+ * Methods: compileAssignment, compileCondition
+ * Usage: compiler.compileAssignment(slot, exp);
+ *        compiler.compileCondition(op, lhs, rhs, lineNumber);
+ * -----------------------------------------------------------
+ * Emit the code for LET and for IF ... THEN.  This is where the
+ * superinstructions are chosen: adding a constant to a variable
+ * becomes OP_INC, comparing a variable with a variable or a constant
+ * becomes a single jump, and such a jump on the line right after an
+ * OP_INC line is merged into it unless some statement jumps to the
+ * IF line.  Anything else is compiled with compileExp.
+ */
+
+    void compileAssignment(int slot, Expression *exp);
+
+    void compileCondition(char op, Expression *lhs, Expression *rhs, int lineNumber);
+
+/*
+ * Methods: emit, emitConstant, emitJump, emitError
+ * Usage: compiler.emit(OP_PRINT);
+ *        compiler.emitConstant(value);
+ *        compiler.emitJump(OP_JUMP, lineNumber);
+ *        compiler.emitError("SYNTAX ERROR");
+ * -------------------------------------------
+ * Append a single instruction.  emitConstant pushes value with
+ * OP_PUSH, or OP_PUSH_WIDE if it does not fit in an int; emitJump
+ * takes the target as a BASIC line number and emitError the message
+ * to raise.
+ */
+
+    void emit(OpCode op, int operand = 0);
+
+    void emitConstant(Value value);
+
+    void emitJump(OpCode op, int lineNumber);
+
+    void emitError(const std::string &message);
+
+private:
+
+    Bytecode bytecode;
+    std::map<int, int> lineStarts;              /* Line number -> offset   */
+    std::vector<std::pair<int, int>> jumps;     /* (offset, line number)   */
+    int depth = 0;                              /* Current stack depth     */
+    std::unordered_set<int> jumpTargets;        /* Lines some jump targets */
+    int currentLine = -1;                       /* Line being compiled     */
+    int pendingIncrement = -1;                  /* OP_INC forming the last line */
+
+    void adjustDepth(OpCode op);
+
+    int emitFused(OpCode op, const FusedOperands &operands);
+
+};
+
+#endif
@@ -7,7 +7,9 @@
  */
 
 
+#include <unordered_map>
 #include "evalstate.hpp"
+#include "Utils/error.hpp"
 
 //using namespace std;
 
@@ -21,20 +23,95 @@ EvalState::~EvalState() {
     /* Empty */
 }
 
-void EvalState::setValue(std::string var, int value) {
-    if(isDefined(var)) symbolTable[var] = value;
-    else symbolTable.emplace(var,value);
+/*
+ * Implementation notes: getSlot, getName
+ * --------------------------------------
+ * The symbol table is a single process-wide interning table: a hash
+ * map from name to slot and a vector from slot back to name.
+ */
+
+static std::unordered_map<std::string, int> &slotTable() {
+    static std::unordered_map<std::string, int> table;
+    return table;
+}
+
+static std::vector<std::string> &nameTable() {
+    static std::vector<std::string> names;
+    return names;
+}
+
+static int findSlot(const std::string &var) {
+    auto it = slotTable().find(var);
+    return it == slotTable().end() ? -1 : it->second;
 }
 
-int EvalState::getValue(std::string var) {
-    if(isDefined(var)) return symbolTable[var];
-    else return 0;
+void EvalState::setValue(const std::string &var, Value value) {
+    setValue(getSlot(var), value);
 }
 
-bool EvalState::isDefined(std::string var) {
-    return symbolTable.find(var)!=symbolTable.end();
+Value EvalState::getValue(const std::string &var) const {
+    int slot = findSlot(var);
+    return slot == -1 ? 0 : getValue(slot);
+}
+
+bool EvalState::isDefined(const std::string &var) const {
+    int slot = findSlot(var);
+    return slot != -1 && isDefined(slot);
 }
 
 void EvalState::Clear() {
-    symbolTable.clear();
+    values.clear();
+    defined.clear();
+    arrays.clear();
+    elements.clear();
+}
+
+void EvalState::dimension(int slot, Value bound) {
+    if (bound < 0 || bound > MAX_ARRAY_BOUND) error("INVALID DIMENSION");
+    reserveSlots(slot + 1);
+    elements[slot].assign(bound + 1, 0);
+    arrays[slot] = {elements[slot].data(), bound + 1};
+}
+
+void EvalState::elementError(int slot) const {
+    if (slot >= int(arrays.size()) || arrays[slot].length == 0) error("ARRAY NOT DIMENSIONED");
+    error("SUBSCRIPT OUT OF RANGE");
+    __builtin_unreachable();
+}
+
+int EvalState::getSlot(const std::string &var) {
+    auto result = slotTable().emplace(var, int(nameTable().size()));
+    if (result.second) nameTable().push_back(var);
+    return result.first->second;
+}
+
+const std::string &EvalState::getName(int slot) {
+    return nameTable()[slot];
+}
+
+int EvalState::getSlotCount() {
+    return int(nameTable().size());
+}
+
+void EvalState::reserveSlots(int count) {
+    if (count > int(values.size())) {
+        values.resize(count, 0);
+        defined.resize(count, 0);
+    }
+    if (count > int(arrays.size())) {
+        arrays.resize(count, ArrayRef{nullptr, 0});
+        elements.resize(count);
+    }
+}
+
+Value *EvalState::getValueArray() {
+    return values.data();
+}
+
+unsigned char *EvalState::getDefinedArray() {
+    return defined.data();
+}
+
+ArrayRef *EvalState::getArrayTable() {
+    return arrays.data();
 }
@@ -10,7 +10,20 @@
 #define _evalstate_h
 
 #include <string>
-#include <map>
+#include <vector>
+#include "numeric.hpp"
+
+/*
+ * Type: ArrayRef
+ * --------------
+ * The storage of one array as generated code sees it: its elements
+ * and their number, which is 0 while the array is not dimensioned.
+ */
+
+struct ArrayRef {
+    Value *data;
+    long long length;
+};
 
 /*
  * Class: EvalState
@@ -22,6 +35,17 @@
  * is a symbol table that maps variable names into their values.
  * In your implementation, you may include additional information
  * in the EvalState class.
+ *
+ * Variables are resolved to dense integer slots when a statement is
+ * parsed (see getSlot), so that at run time a variable is just an
+ * index into a contiguous value array, with a byte array recording
+ * which slots have been assigned.  The name-based methods remain for
+ * callers that only have a name.
+ *
+ * An array dimensioned with DIM uses the slot of its name as well,
+ * but in a separate table, so A and A(i) are different variables.
+ * Each array's elements are one contiguous block, and an element is
+ * reached as that block plus the subscript.
  */
 
 class EvalState {
@@ -49,36 +73,183 @@ public:
 /*
  * Method: setValue
  * Usage: state.setValue(var, value);
- * ----------------------------------
+ *        state.setValue(slot, value);
+ * -----------------------------------
  * Sets the value associated with the specified var.
  */
 
-    void setValue(std::string var, int value);
+    void setValue(const std::string &var, Value value);
+
+    void setValue(int slot, Value value);
 
 /*
  * Method: getValue
- * Usage: int value = state.getValue(var);
- * ---------------------------------------
- * Returns the value associated with the specified variable.
+ * Usage: Value value = state.getValue(var);
+ *        Value value = state.getValue(slot);
+ * ------------------------------------------
+ * Returns the value associated with the specified variable, or 0 if
+ * it has not been defined.
  */
 
-    int getValue(std::string var);
+    Value getValue(const std::string &var) const;
+
+    Value getValue(int slot) const;
 
 /*
  * Method: isDefined
  * Usage: if (state.isDefined(var)) . . .
- * --------------------------------------
+ *        if (state.isDefined(slot)) . . .
+ * ---------------------------------------
  * Returns true if the specified variable is defined.
  */
 
-    bool isDefined(std::string var);
+    bool isDefined(const std::string &var) const;
+
+    bool isDefined(int slot) const;
+
+/*
+ * Method: dimension
+ * Usage: state.dimension(slot, bound);
+ * ------------------------------------
+ * Gives the array in slot the elements 0 through bound, all zero,
+ * replacing any previous contents.  bound must be from 0 to
+ * MAX_ARRAY_BOUND, or INVALID DIMENSION is raised.
+ */
+
+    void dimension(int slot, Value bound);
+
+    static const int MAX_ARRAY_BOUND = (1 << 24) - 1;
+
+/*
+ * Methods: getElement, setElement
+ * Usage: Value value = state.getElement(slot, index);
+ *        state.setElement(slot, index, value);
+ * --------------------------------------------------
+ * Read and write element index of the array in slot.  An array that
+ * has not been dimensioned raises ARRAY NOT DIMENSIONED, and an index
+ * outside it SUBSCRIPT OUT OF RANGE.
+ */
+
+    Value getElement(int slot, Value index) const;
+
+    void setElement(int slot, Value index, Value value);
+
+/*
+ * Method: Clear
+ * Usage: state.Clear();
+ * ---------------------
+ * Undefines every variable and array.  Slot numbers are kept, so
+ * statements that have already been parsed stay valid.
+ */
 
     void Clear();
 
+/*
+ * Method: getSlot
+ * Usage: int slot = EvalState::getSlot(var);
+ * ------------------------------------------
+ * Returns the slot number of the variable var, assigning the next
+ * free slot the first time the name is seen.  Slots are shared by
+ * every EvalState, so they can be resolved at parse time.
+ */
+
+    static int getSlot(const std::string &var);
+
+/*
+ * Method: getName
+ * Usage: std::string var = EvalState::getName(slot);
+ * --------------------------------------------------
+ * Returns the name of the variable stored in the given slot.
+ */
+
+    static const std::string &getName(int slot);
+
+/*
+ * Method: getSlotCount
+ * Usage: int count = EvalState::getSlotCount();
+ * ---------------------------------------------
+ * Returns the number of slots handed out so far.
+ */
+
+    static int getSlotCount();
+
+/*
+ * Methods: reserveSlots, getValueArray, getDefinedArray, getArrayTable
+ * Usage: state.reserveSlots(EvalState::getSlotCount());
+ *        Value *values = state.getValueArray();
+ *        unsigned char *defined = state.getDefinedArray();
+ *        ArrayRef *arrays = state.getArrayTable();
+ * ---------------------------------------------------------------------
+ * Give generated code direct access to the slot storage.  After
+ * reserveSlots(count) all three tables have at least count entries,
+ * and they stay in place until a higher slot is used or Clear is
+ * called.  A nonzero byte in the defined array marks an assigned
+ * slot.  The entries of the array table change when an array is
+ * dimensioned.
+ */
+
+    void reserveSlots(int count);
+
+    Value *getValueArray();
+
+    unsigned char *getDefinedArray();
+
+    ArrayRef *getArrayTable();
+
 private:
 
-    std::map<std::string, int> symbolTable;
+    std::vector<Value> values;            /* Value of each slot             */
+    std::vector<unsigned char> defined;   /* Which slots have been assigned */
+    std::vector<ArrayRef> arrays;         /* Array of each slot             */
+    std::vector<std::vector<Value>> elements;   /* Storage behind arrays    */
+
+    Value *element(int slot, Value index) const;
+
+    [[noreturn]] void elementError(int slot) const;
 
 };
 
+/*
+ * The slot-based methods are on the hot path of every evaluation and
+ * are defined here so that they can be inlined.
+ */
+
+inline void EvalState::setValue(int slot, Value value) {
+    if (slot >= int(values.size())) {
+        values.resize(slot + 1, 0);
+        defined.resize(slot + 1, 0);
+    }
+    values[slot] = value;
+    defined[slot] = 1;
+}
+
+inline Value EvalState::getValue(int slot) const {
+    return isDefined(slot) ? values[slot] : 0;
+}
+
+inline bool EvalState::isDefined(int slot) const {
+    return slot < int(defined.size()) && defined[slot] != 0;
+}
+
+/*
+ * The subscript is compared as an unsigned number, which also rejects
+ * negative ones, and an undimensioned array has length 0, so a single
+ * comparison guards every access.
+ */
+
+inline Value *EvalState::element(int slot, Value index) const {
+    if (slot >= int(arrays.size()) || (unsigned long long) index >= (unsigned long long) arrays[slot].length) {
+        elementError(slot);
+    }
+    return arrays[slot].data + index;
+}
+
+inline Value EvalState::getElement(int slot, Value index) const {
+    return *element(slot, index);
+}
+
+inline void EvalState::setElement(int slot, Value index, Value value) {
+    *element(slot, index) = value;
+}
+
 #endif
@@ -17,6 +17,17 @@ Expression::Expression() = default;
 
 Expression::~Expression() = default;
 
+std::string operatorName(Operator op) {
+    switch (op) {
+        case ASSIGN: return "=";
+        case ADD: return "+";
+        case SUBTRACT: return "-";
+        case MULTIPLY: return "*";
+        case DIVIDE: return "/";
+    }
+    return "";
+}
+
 /*
  * Implementation notes: the ConstantExp subclass
  * ----------------------------------------------
@@ -25,23 +36,23 @@ Expression::~Expression() = default;
  * value of state but needs it to match the general prototype for eval.
  */
 
-ConstantExp::ConstantExp(int value) {
+ConstantExp::ConstantExp(Value value) {
     this->value = value;
 }
 
-int ConstantExp::eval(EvalState &state) {
+Value ConstantExp::eval(EvalState &state) {
     return value;
 }
 
 std::string ConstantExp::toString() {
-    return integerToString(value);
+    return std::to_string(value);
 }
 
 ExpressionType ConstantExp::getType() {
     return CONSTANT;
 }
 
-int ConstantExp::getValue() {
+Value ConstantExp::getValue() {
     return value;
 }
 
@@ -49,17 +60,19 @@ int ConstantExp::getValue() {
  * Implementation notes: the IdentifierExp subclass
  * ------------------------------------------------
  * The IdentifierExp subclass declares a single instance variable that
- * stores the name of the variable.  The implementation of eval must
- * look this variable up in the evaluation state.
+ * stores the name of the variable, together with the slot that name
+ * resolves to.  The implementation of eval looks the slot up in the
+ * evaluation state.
  */
 
 IdentifierExp::IdentifierExp(std::string name) {
     this->name = name;
+    this->slot = EvalState::getSlot(name);
 }
 
-int IdentifierExp::eval(EvalState &state) {
-    if (!state.isDefined(name)) error("VARIABLE NOT DEFINED");
-    return state.getValue(name);
+Value IdentifierExp::eval(EvalState &state) {
+    if (!state.isDefined(slot)) error("VARIABLE NOT DEFINED");
+    return state.getValue(slot);
 }
 
 std::string IdentifierExp::toString() {
@@ -74,6 +87,10 @@ std::string IdentifierExp::getName() {
     return name;
 }
 
+int IdentifierExp::getSlot() {
+    return slot;
+}
+
 /*
  * Implementation notes: the CompoundExp subclass
  * ----------------------------------------------
@@ -82,57 +99,66 @@ std::string IdentifierExp::getName() {
  * evaluates the subexpressions recursively and then applies the operator.
  */
 
-CompoundExp::CompoundExp(std::string op, Expression *lhs, Expression *rhs) {
+CompoundExp::CompoundExp(Operator op, Expression *lhs, Expression *rhs) {
     this->op = op;
     this->lhs = lhs;
     this->rhs = rhs;
 }
 
-CompoundExp::~CompoundExp() {
-    delete lhs;
-    delete rhs;
-}
-
 /*
  * Implementation notes: eval
  * --------------------------
  * The eval method for the compound expression case must check for the
  * assignment operator as a special case.  Unlike the arithmetic operators
- * the assignment operator does not evaluate its left operand.
+ * the assignment operator does not evaluate its left operand.  Assigning
+ * to LET is rejected by comparing slots, which avoids a string compare.
+ * The operator itself is applied in the type of the numeric mode.
  */
 
-int CompoundExp::eval(EvalState &state) {
-    if (op == "=") {
+template <typename T>
+static T apply(Operator op, T left, T right) {
+    switch (op) {
+        case ADD:
+            return Arithmetic<T>::add(left, right);
+        case SUBTRACT:
+            return Arithmetic<T>::subtract(left, right);
+        case MULTIPLY:
+            return Arithmetic<T>::multiply(left, right);
+        case DIVIDE:
+            return Arithmetic<T>::divide(left, right);
+        default:
+            return 0;
+    }
+}
+
+Value CompoundExp::eval(EvalState &state) {
+    if (op == ASSIGN) {
+        static const int letSlot = EvalState::getSlot("LET");
         if (lhs->getType() != IDENTIFIER) {
             error("Illegal variable in assignment");
         }
-        if (lhs->getType() == IDENTIFIER && lhs->toString() == "LET")
+        if (((IdentifierExp *) lhs)->getSlot() == letSlot)
             error("SYNTAX ERROR");
-        int val = rhs->eval(state);
-        state.setValue(((IdentifierExp *) lhs)->getName(), val);
+        Value val = rhs->eval(state);
+        state.setValue(((IdentifierExp *) lhs)->getSlot(), val);
         return val;
     }
-    int left = lhs->eval(state);
-    int right = rhs->eval(state);
-    if (op == "+") return left + right;
-    if (op == "-") return left - right;
-    if (op == "*") return left * right;
-    if (op == "/") {
-        if (right == 0) error("DIVIDE BY ZERO");
-        return left / right;
-    }
-    return 0;
+    Value left = lhs->eval(state);
+    Value right = rhs->eval(state);
+    if (op == DIVIDE && right == 0) error("DIVIDE BY ZERO");
+    if (numericMode == NUMERIC_INT64) return apply<long long>(op, left, right);
+    return apply<int>(op, int(left), int(right));
 }
 
 std::string CompoundExp::toString() {
-    return '(' + lhs->toString() + ' ' + op + ' ' + rhs->toString() + ')';
+    return '(' + lhs->toString() + ' ' + operatorName(op) + ' ' + rhs->toString() + ')';
 }
 
 ExpressionType CompoundExp::getType() {
     return COMPOUND;
 }
 
-std::string CompoundExp::getOp() {
+Operator CompoundExp::getOp() {
     return op;
 }
 
@@ -143,3 +169,40 @@ Expression *CompoundExp::getLHS() {
 Expression *CompoundExp::getRHS() {
     return rhs;
 }
+
+/*
+ * Implementation notes: the ArrayExp subclass
+ * -------------------------------------------
+ * The subscript is evaluated first; EvalState then checks that the
+ * array is dimensioned and the subscript is inside it.
+ */
+
+ArrayExp::ArrayExp(std::string name, Expression *index) {
+    this->name = name;
+    this->slot = EvalState::getSlot(name);
+    this->index = index;
+}
+
+Value ArrayExp::eval(EvalState &state) {
+    return state.getElement(slot, index->eval(state));
+}
+
+std::string ArrayExp::toString() {
+    return name + '(' + index->toString() + ')';
+}
+
+ExpressionType ArrayExp::getType() {
+    return ARRAY;
+}
+
+std::string ArrayExp::getName() {
+    return name;
+}
+
+int ArrayExp::getSlot() {
+    return slot;
+}
+
+Expression *ArrayExp::getIndex() {
+    return index;
+}
@@ -17,26 +17,48 @@
 /*
  * Type: ExpressionType
  * --------------------
- * This enumerated type is used to differentiate the three different
- * expression types: CONSTANT, IDENTIFIER, and COMPOUND.
+ * This enumerated type is used to differentiate the four different
+ * expression types: CONSTANT, IDENTIFIER, COMPOUND and ARRAY.
  */
 
 enum ExpressionType {
-    CONSTANT, IDENTIFIER, COMPOUND
+    CONSTANT, IDENTIFIER, COMPOUND, ARRAY
 };
 
+/*
+ * Type: Operator
+ * --------------
+ * This enumerated type identifies the operator of a compound
+ * expression.  The parser resolves each operator token to one of
+ * these values once, so evaluation never has to look at the text.
+ */
+
+enum Operator {
+    ASSIGN, ADD, SUBTRACT, MULTIPLY, DIVIDE
+};
+
+/*
+ * Function: operatorName
+ * Usage: std::string str = operatorName(op);
+ * ------------------------------------------
+ * Returns the source text of the operator, such as "+" for ADD.
+ */
+
+std::string operatorName(Operator op);
+
 /*
  * Class: Expression
  * -----------------
  * This class is used to represent a node in an expression tree.
  * Expression is an example of an abstract class, which defines
  * the structure and behavior of a set of classes but has no
- * objects of its own.  Any object must be one of the three
+ * objects of its own.  Any object must be one of the four
  * concrete subclasses of Expression:
  *
  *  1. ConstantExp   -- an integer constant
  *  2. IdentifierExp -- a string representing an identifier
  *  3. CompoundExp   -- two expressions combined by an operator
+ *  4. ArrayExp      -- an element of an array, such as A(I + 1)
  *
  * The Expression class defines the interface common to all
  * Expression objects; each subclass provides its own specific
@@ -63,24 +85,23 @@ public:
 
 /*
  * Destructor: ~Expression
- * Usage: delete exp;
- * ------------------
- * The destructor deallocates the storage for this expression.
- * It must be declared virtual to ensure that the correct subclass
- * destructor is called when deleting an expression.
+ * -----------------------
+ * Expression nodes are allocated in the Arena of the line they belong
+ * to, which runs this destructor when it is released.  A node does
+ * not own its subexpressions; they live in the same arena.
  */
 
     virtual ~Expression();
 
 /*
  * Method: eval
- * Usage: int value = exp->eval(state);
- * ------------------------------------
+ * Usage: Value value = exp->eval(state);
+ * --------------------------------------
  * Evaluates this expression and returns its value in the context of
  * the specified EvalState object.
  */
 
-    virtual int eval(EvalState &state) = 0;
+    virtual Value eval(EvalState &state) = 0;
 
 /*
  * Method: toString
@@ -96,7 +117,7 @@ public:
  * Usage: ExpressionType type = exp->getType();
  * --------------------------------------------
  * Returns the type of the expression, which must be one of the constants
- * CONSTANT, IDENTIFIER, or COMPOUND.
+ * CONSTANT, IDENTIFIER, COMPOUND or ARRAY.
  */
 
     virtual ExpressionType getType() = 0;
@@ -115,13 +136,13 @@ public:
 
 /*
  * Constructor: ConstantExp
- * Usage: Expression *exp = new ConstantExp(value);
+ * Usage: Expression *exp = arena.make<ConstantExp>(value);
  * ------------------------------------------------
  * The constructor initializes a new integer constant expression
  * to the given value.
  */
 
-    ConstantExp(int value);
+    ConstantExp(Value value);
 
 /*
  * Prototypes for the virtual methods
@@ -130,7 +151,7 @@ public:
  * base class and don't require additional documentation.
  */
 
-    virtual int eval(EvalState &state);
+    virtual Value eval(EvalState &state);
 
     virtual std::string toString();
 
@@ -138,17 +159,17 @@ public:
 
 /*
  * Method: getValue
- * Usage: int value = ((ConstantExp *) exp)->getValue();
- * -----------------------------------------------------
+ * Usage: Value value = ((ConstantExp *) exp)->getValue();
+ * -------------------------------------------------------
  * Returns the value field without calling eval and can be applied
  * only to an object known to be a ConstantExp.
  */
 
-    int getValue();
+    Value getValue();
 
 private:
 
-    int value;
+    Value value;
 
 };
 
@@ -164,7 +185,7 @@ public:
 
 /*
  * Constructor: IdentifierExp
- * Usage: Expression *exp = new IdentifierExp(name);
+ * Usage: Expression *exp = arena.make<IdentifierExp>(name);
  * -------------------------------------------------
  * The constructor initializes a new identifier expression
  * for the variable named by name.
@@ -179,7 +200,7 @@ public:
  * base class and don't require additional documentation.
  */
 
-    virtual int eval(EvalState &state);
+    virtual Value eval(EvalState &state);
 
     virtual std::string toString();
 
@@ -195,9 +216,20 @@ public:
 
     std::string getName();
 
+/*
+ * Method: getSlot
+ * Usage: int slot = ((IdentifierExp *) exp)->getSlot();
+ * -----------------------------------------------------
+ * Returns the EvalState slot that the name was resolved to when the
+ * node was created.
+ */
+
+    int getSlot();
+
 private:
 
     std::string name;
+    int slot;
 
 };
 
@@ -214,14 +246,14 @@ public:
 
 /*
  * Constructor: CompoundExp
- * Usage: Expression *exp = new CompoundExp(op, lhs, rhs);
+ * Usage: Expression *exp = arena.make<CompoundExp>(op, lhs, rhs);
  * -------------------------------------------------------
  * The constructor initializes a new compound expression
  * which is composed of the operator (op) and the left and
  * right subexpression (lhs and rhs).
  */
 
-    CompoundExp(std::string op, Expression *lhs, Expression *rhs);
+    CompoundExp(Operator op, Expression *lhs, Expression *rhs);
 
 /*
  * Prototypes for the virtual methods
@@ -230,9 +262,7 @@ public:
  * base class and don't require additional documentation.
  */
 
-    virtual ~CompoundExp();
-
-    virtual int eval(EvalState &state);
+    virtual Value eval(EvalState &state);
 
     virtual std::string toString();
 
@@ -240,7 +270,7 @@ public:
 
 /*
  * Methods: getOp, getLHS, getRHS
- * Usage: string op = ((CompoundExp *) exp)->getOp();
+ * Usage: Operator op = ((CompoundExp *) exp)->getOp();
  *        Expression *lhs = ((CompoundExp *) exp)->getLHS();
  *        Expression *rhs = ((CompoundExp *) exp)->getRHS();
  * ---------------------------------------------------------
@@ -248,7 +278,7 @@ public:
  * be applied only to an object known to be a CompoundExp.
  */
 
-    std::string getOp();
+    Operator getOp();
 
     Expression *getLHS();
 
@@ -256,9 +286,69 @@ public:
 
 private:
 
-    std::string op;
+    Operator op;
     Expression *lhs, *rhs;
 
 };
 
+/*
+ * Class: ArrayExp
+ * ---------------
+ * This subclass represents an element of an array: the array's name
+ * followed by a subscript in parentheses.  The name is resolved to a
+ * slot when the node is created, so evaluating it is the subscript
+ * plus a bounds-checked access to that array's storage.
+ */
+
+class ArrayExp : public Expression {
+
+public:
+
+/*
+ * Constructor: ArrayExp
+ * Usage: Expression *exp = arena.make<ArrayExp>(name, index);
+ * -----------------------------------------------------------
+ * The constructor initializes a new element expression for the
+ * array named by name and the subscript index.
+ */
+
+    ArrayExp(std::string name, Expression *index);
+
+/*
+ * Prototypes for the virtual methods
+ * ----------------------------------
+ * These methods have the same prototypes as those in the Expression
+ * base class and don't require additional documentation.
+ */
+
+    virtual Value eval(EvalState &state);
+
+    virtual std::string toString();
+
+    virtual ExpressionType getType();
+
+/*
+ * Methods: getName, getSlot, getIndex
+ * Usage: string name = ((ArrayExp *) exp)->getName();
+ *        int slot = ((ArrayExp *) exp)->getSlot();
+ *        Expression *index = ((ArrayExp *) exp)->getIndex();
+ * ----------------------------------------------------------
+ * These methods return the components of an element node and can be
+ * applied only to an object known to be an ArrayExp.
+ */
+
+    std::string getName();
+
+    int getSlot();
+
+    Expression *getIndex();
+
+private:
+
+    std::string name;
+    int slot;
+    Expression *index;
+
+};
+
 #endif
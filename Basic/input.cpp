@@ -0,0 +1,67 @@
+/*
+ * File: input.cpp
+ * ---------------
+ * Implements the input.hpp interface.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "input.hpp"
+#include "sampler.hpp"
+
+
+Input::Input(int fd) : fd(fd), buffer(CHUNK_SIZE), start(0), end(0), eof(false) { }
+
+bool Input::readLine(std::string_view &line) {
+    while (true) {
+        const char *data = buffer.data();
+        const void *newline = std::memchr(data + start, '\n', end - start);
+        if (newline != nullptr) {
+            std::size_t stop = static_cast<const char *>(newline) - data;
+            line = std::string_view(data + start, stop - start);
+            start = stop + 1;
+            return true;
+        }
+        if (eof) {
+            if (start == end) return false;
+            line = std::string_view(data + start, end - start);
+            start = end;
+            return true;
+        }
+        fill();
+    }
+}
+
+/*
+ * Implementation notes: fill
+ * --------------------------
+ * Moves the unfinished line to the front of the buffer, doubling the
+ * buffer if that line already fills it, and appends one more chunk
+ * from the file descriptor.
+ */
+
+void Input::fill() {
+    SamplerPhase phase(PHASE_IO);
+    if (start > 0) {
+        std::memmove(buffer.data(), buffer.data() + start, end - start);
+        end -= start;
+        start = 0;
+    }
+    if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+    while (true) {
+        ssize_t n = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            eof = true;
+        } else {
+            end += n;
+        }
+        return;
+    }
+}
+
+Input &input() {
+    static Input standardInput(STDIN_FILENO);
+    return standardInput;
+}
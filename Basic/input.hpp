@@ -0,0 +1,74 @@
+/*
+ * File: input.hpp
+ * ---------------
+ * This interface exports the Input class, through which the
+ * interpreter reads both the lines typed at the prompt and the values
+ * requested by INPUT.
+ */
+
+#ifndef _input_h
+#define _input_h
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/*
+ * Class: Input
+ * ------------
+ * Reads a file descriptor in large chunks and splits the data into
+ * lines in place.  Each line is returned as a string_view into the
+ * buffer, so no string is built for a line unless the caller copies
+ * it.  A line that is split across two chunks is moved to the front
+ * of the buffer before the next chunk is read, and the buffer grows
+ * if a single line does not fit.
+ */
+
+class Input {
+
+public:
+
+/*
+ * Constructor: Input
+ * Usage: Input in(fd);
+ * --------------------
+ * Creates a reader for the file descriptor fd.
+ */
+
+    explicit Input(int fd);
+
+/*
+ * Method: readLine
+ * Usage: while (in.readLine(line)) ...
+ * ------------------------------------
+ * Stores the next line, without its newline, in line and returns true,
+ * or returns false at the end of the input.  The view is only valid
+ * until the next call to readLine.
+ */
+
+    bool readLine(std::string_view &line);
+
+private:
+
+    static const std::size_t CHUNK_SIZE = 1 << 16;
+
+    int fd;                     /* Source file descriptor           */
+    std::vector<char> buffer;   /* Data read but not yet consumed   */
+    std::size_t start;          /* First unconsumed byte in buffer  */
+    std::size_t end;            /* One past the last byte read      */
+    bool eof;                   /* Whether read has returned 0      */
+
+    void fill();
+
+};
+
+/*
+ * Function: input
+ * Usage: input().readLine(line);
+ * ------------------------------
+ * Returns the interpreter's standard input reader.
+ */
+
+Input &input();
+
+#endif
@@ -0,0 +1,547 @@
+/*
+ * File: jit.cpp
+ * -------------
+ * Implements the jit.hpp interface.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include "jit.hpp"
+
+#if BASIC_JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+
+Jit::Jit(const Bytecode &bytecode)
+    : bytecode(bytecode),
+      counters(bytecode.code.size(), 0),
+      entries(bytecode.code.size(), nullptr),
+      failed(bytecode.code.size(), false) { }
+
+Jit::~Jit() {
+#if BASIC_JIT_SUPPORTED
+    for (const auto &block : blocks) {
+        munmap(block.first, block.second);
+    }
+#endif
+}
+
+JitFunction Jit::backEdge(int from, int target) {
+    if (entries[target] != nullptr || failed[target]) return entries[target];
+    if (++counters[target] < HOT_THRESHOLD) return nullptr;
+    entries[target] = compile(target, from);
+    if (entries[target] == nullptr) failed[target] = true;
+    return entries[target];
+}
+
+#if !BASIC_JIT_SUPPORTED
+
+JitFunction Jit::compile(int start, int end) {
+    return nullptr;
+}
+
+#else
+
+namespace {
+
+/*
+ * Register numbers
+ * ----------------
+ * The native code keeps the operand stack pointer in rbx, the value
+ * and defined arrays in r12 and r13, and the JitFrame in r14, all of
+ * which are callee-saved.  eax, ecx and edx are scratch.  Stack
+ * entries and variables are VALUE_SIZE bytes wide.
+ */
+
+enum Register {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RDI = 7, R12 = 12, R13 = 13, R14 = 14
+};
+
+const int VALUE_SIZE = sizeof(Value);
+
+/*
+ * Condition codes
+ * ---------------
+ * The low nibble of the Jcc opcodes used here.
+ */
+
+enum Condition {
+    CC_ABOVE_EQUAL = 0x3, CC_EQUAL = 0x4, CC_NOT_EQUAL = 0x5, CC_LESS = 0xC, CC_GREATER = 0xF
+};
+
+/*
+ * Class: Assembler
+ * ----------------
+ * Appends x86-64 instructions to a byte array.  Every memory operand
+ * is written as [base + disp32], which keeps the encoder to a single
+ * addressing form.
+ */
+
+class Assembler {
+
+public:
+
+    std::vector<unsigned char> code;
+
+    std::size_t position() const {
+        return code.size();
+    }
+
+    void byte(int value) {
+        code.push_back((unsigned char) value);
+    }
+
+    void dword(int32_t value) {
+        unsigned char bytes[4];
+        std::memcpy(bytes, &value, 4);
+        code.insert(code.end(), bytes, bytes + 4);
+    }
+
+/*
+ * Method: memory
+ * --------------
+ * Emits an instruction with a REX prefix if needed, the opcode bytes
+ * and a ModRM operand for [base + disp].  reg is the register operand
+ * or the opcode extension.
+ */
+
+    void memory(bool wide, std::initializer_list<int> opcode, int reg, int base, int32_t disp) {
+        int rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((base & 8) ? 1 : 0);
+        if (rex != 0x40) byte(rex);
+        for (int op : opcode) byte(op);
+        byte(0x80 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == 4) byte(0x24);
+        dword(disp);
+    }
+
+    void load(int reg, int base, int32_t disp) {                /* mov r32, [m]  */
+        memory(false, {0x8B}, reg, base, disp);
+    }
+
+    void storeImmediate(int base, int32_t disp, int32_t value) { /* mov [m], imm */
+        memory(false, {0xC7}, 0, base, disp);
+        dword(value);
+    }
+
+    void storeImmediate64(int base, int32_t disp, int32_t value) { /* mov qword [m], imm */
+        memory(true, {0xC7}, 0, base, disp);
+        dword(value);
+    }
+
+    void storeByte(int base, int32_t disp, int value) {         /* mov byte [m]  */
+        memory(false, {0xC6}, 0, base, disp);
+        byte(value);
+    }
+
+    void compareByte(int base, int32_t disp, int value) {       /* cmp byte [m]  */
+        memory(false, {0x80}, 7, base, disp);
+        byte(value);
+    }
+
+    void load64(int reg, int base, int32_t disp) {              /* mov r64, [m]  */
+        memory(true, {0x8B}, reg, base, disp);
+    }
+
+    void store64(int base, int32_t disp, int reg) {             /* mov [m], r64  */
+        memory(true, {0x89}, reg, base, disp);
+    }
+
+    void add(int reg, int base, int32_t disp) {                 /* add r32, [m]  */
+        memory(false, {0x03}, reg, base, disp);
+    }
+
+    void subtract(int reg, int base, int32_t disp) {            /* sub r32, [m]  */
+        memory(false, {0x2B}, reg, base, disp);
+    }
+
+    void multiply(int reg, int base, int32_t disp) {            /* imul r32, [m] */
+        memory(false, {0x0F, 0xAF}, reg, base, disp);
+    }
+
+    void compare(int reg, int base, int32_t disp) {             /* cmp r32, [m]  */
+        memory(false, {0x3B}, reg, base, disp);
+    }
+
+    void compare64(int reg, int base, int32_t disp) {           /* cmp r64, [m]  */
+        memory(true, {0x3B}, reg, base, disp);
+    }
+
+    void compareEaxImmediate(int32_t value) {                   /* cmp eax, imm  */
+        byte(0x3D);
+        dword(value);
+    }
+
+    void addEaxImmediate(int32_t value) {                       /* add eax, imm  */
+        byte(0x05);
+        dword(value);
+    }
+
+    void adjustStack(int bytes) {                               /* add rbx, imm8 */
+        byte(0x48);
+        byte(0x83);
+        byte(bytes >= 0 ? 0xC3 : 0xEB);
+        byte(bytes >= 0 ? bytes : -bytes);
+    }
+
+    void divideEcx() {                                          /* cdq; idiv ecx */
+        byte(0x99);
+        byte(0xF7);
+        byte(0xF9);
+    }
+
+    void testEcx() {                                            /* test ecx, ecx */
+        byte(0x85);
+        byte(0xC9);
+    }
+
+    void compareEcxMinusOne() {                                 /* cmp ecx, -1   */
+        byte(0x83);
+        byte(0xF9);
+        byte(0xFF);
+    }
+
+    void negateEax() {                                          /* neg eax       */
+        byte(0xF7);
+        byte(0xD8);
+    }
+
+    void signExtendEax() {                                      /* cdqe          */
+        byte(0x48);
+        byte(0x98);
+    }
+
+    void addressRaxRcx() {                          /* shl rax, 3; add rax, rcx */
+        byte(0x48); byte(0xC1); byte(0xE0); byte(3);
+        byte(0x48); byte(0x01); byte(0xC8);
+    }
+
+/*
+ * Methods: jump, jumpIf, patch
+ * ----------------------------
+ * Emit a jump with a 32-bit displacement and return the position of
+ * that displacement, which patch later points at its destination.
+ */
+
+    std::size_t jump() {
+        byte(0xE9);
+        dword(0);
+        return position() - 4;
+    }
+
+    std::size_t jumpIf(Condition condition) {
+        byte(0x0F);
+        byte(0x80 | condition);
+        dword(0);
+        return position() - 4;
+    }
+
+    void patch(std::size_t at, std::size_t destination) {
+        int32_t rel = int32_t(destination) - int32_t(at + 4);
+        std::memcpy(&code[at], &rel, 4);
+    }
+
+};
+
+/*
+ * Class: LoopCompiler
+ * -------------------
+ * Translates the instructions from start to end, one at a time, into
+ * native code.  Jumps to an instruction inside the range go straight
+ * to its code; everything that leaves the range, and every point where
+ * the interpreter has to take over, goes through an exit stub that
+ * stores the offset to resume at.
+ */
+
+class LoopCompiler {
+
+public:
+
+    LoopCompiler(const Bytecode &bytecode, int start, int end)
+        : bytecode(bytecode), start(start), end(end), labels(end - start + 1) { }
+
+    std::vector<unsigned char> compile();
+
+private:
+
+    const Bytecode &bytecode;
+    int start;
+    int end;
+    Assembler a;
+    std::vector<std::size_t> labels;                        /* Code of each instruction */
+    std::vector<std::pair<std::size_t, int>> branches;      /* Jumps within the loop    */
+    std::vector<std::pair<std::size_t, int>> exits;         /* Jumps to the interpreter */
+
+    void compileInstruction(int offset, const Instruction &ins);
+
+    void jumpTo(std::size_t at, int target);
+
+    void exitIfUndefined(int slot, int offset);
+
+    void loadVariable(int reg, int slot);
+
+    void storeEax(int base, int32_t disp);
+
+    void compareAndJump(const FusedOperands &f, bool isVariable, Condition condition);
+
+    void elementAddress(int slot, int32_t indexDisp, int offset);
+
+};
+
+void LoopCompiler::jumpTo(std::size_t at, int target) {
+    if (target >= start && target <= end) {
+        branches.emplace_back(at, target);
+    } else {
+        exits.emplace_back(at, target);
+    }
+}
+
+void LoopCompiler::exitIfUndefined(int slot, int offset) {
+    a.compareByte(R13, slot, 0);
+    exits.emplace_back(a.jumpIf(CC_EQUAL), offset);
+}
+
+void LoopCompiler::loadVariable(int reg, int slot) {
+    a.load(reg, R12, slot * VALUE_SIZE);
+}
+
+void LoopCompiler::storeEax(int base, int32_t disp) {
+    a.signExtendEax();
+    a.store64(base, disp, RAX);
+}
+
+void LoopCompiler::compareAndJump(const FusedOperands &f, bool isVariable, Condition condition) {
+    loadVariable(RAX, f.lhs);
+    if (isVariable) {
+        a.compare(RAX, R12, f.rhs * VALUE_SIZE);
+    } else {
+        a.compareEaxImmediate(f.rhs);
+    }
+    jumpTo(a.jumpIf(condition), f.target);
+}
+
+/*
+ * Implementation notes: elementAddress
+ * ------------------------------------
+ * Leaves in rax the address of the element of array slot whose index
+ * is on the operand stack at [rbx + indexDisp].  The table is read
+ * through the frame each time, since a DIM outside the loop may have
+ * moved the storage.  An index that is negative or past the end
+ * compares above or equal as unsigned and exits to the interpreter,
+ * which raises the error.
+ */
+
+void LoopCompiler::elementAddress(int slot, int32_t indexDisp, int offset) {
+    int32_t entry = slot * int32_t(sizeof(ArrayRef));
+    a.load64(RAX, RBX, indexDisp);
+    a.load64(RCX, R14, offsetof(JitFrame, arrays));
+    a.compare64(RAX, RCX, entry + offsetof(ArrayRef, length));
+    exits.emplace_back(a.jumpIf(CC_ABOVE_EQUAL), offset);
+    a.load64(RCX, RCX, entry + offsetof(ArrayRef, data));
+    a.addressRaxRcx();
+}
+
+/*
+ * Implementation notes: compileInstruction
+ * ----------------------------------------
+ * Each instruction checks everything that could make it fail before
+ * it changes any state, so that an exit to the interpreter at its own
+ * offset re-executes it from the beginning.  The fused OP_INC_JUMP_
+ * forms therefore check the variables read after the increment up
+ * front as well.
+ */
+
+void LoopCompiler::compileInstruction(int offset, const Instruction &ins) {
+    static const Condition conditions[] = {CC_LESS, CC_GREATER, CC_EQUAL};
+    switch (ins.op) {
+        case OP_PUSH:
+            a.storeImmediate64(RBX, 0, ins.operand);
+            a.adjustStack(VALUE_SIZE);
+            return;
+        case OP_LOAD:
+            exitIfUndefined(ins.operand, offset);
+            a.load64(RAX, R12, ins.operand * VALUE_SIZE);
+            a.store64(RBX, 0, RAX);
+            a.adjustStack(VALUE_SIZE);
+            return;
+        case OP_STORE:
+            a.adjustStack(-VALUE_SIZE);
+            a.load64(RAX, RBX, 0);
+            a.store64(R12, ins.operand * VALUE_SIZE, RAX);
+            a.storeByte(R13, ins.operand, 1);
+            return;
+        case OP_DUP:
+            a.load64(RAX, RBX, -VALUE_SIZE);
+            a.store64(RBX, 0, RAX);
+            a.adjustStack(VALUE_SIZE);
+            return;
+        case OP_ADD:
+            a.adjustStack(-VALUE_SIZE);
+            a.load(RAX, RBX, -VALUE_SIZE);
+            a.add(RAX, RBX, 0);
+            storeEax(RBX, -VALUE_SIZE);
+            return;
+        case OP_SUB:
+            a.adjustStack(-VALUE_SIZE);
+            a.load(RAX, RBX, -VALUE_SIZE);
+            a.subtract(RAX, RBX, 0);
+            storeEax(RBX, -VALUE_SIZE);
+            return;
+        case OP_MUL:
+            a.adjustStack(-VALUE_SIZE);
+            a.load(RAX, RBX, -VALUE_SIZE);
+            a.multiply(RAX, RBX, 0);
+            storeEax(RBX, -VALUE_SIZE);
+            return;
+        case OP_DIV: {
+            a.load(RCX, RBX, -VALUE_SIZE);
+            a.testEcx();
+            exits.emplace_back(a.jumpIf(CC_EQUAL), offset);
+            a.adjustStack(-VALUE_SIZE);
+            a.load(RAX, RBX, -VALUE_SIZE);
+            a.compareEcxMinusOne();//idiv 对 INT_MIN / -1 会陷入，改为取负
+            std::size_t divide = a.jumpIf(CC_NOT_EQUAL);
+            a.negateEax();
+            std::size_t done = a.jump();
+            a.patch(divide, a.position());
+            a.divideEcx();
+            a.patch(done, a.position());
+            storeEax(RBX, -VALUE_SIZE);
+            return;
+        }
+        case OP_LOAD_ELEMENT:
+            elementAddress(ins.operand, -VALUE_SIZE, offset);
+            a.load64(RAX, RAX, 0);
+            a.store64(RBX, -VALUE_SIZE, RAX);
+            return;
+        case OP_STORE_ELEMENT:
+            elementAddress(ins.operand, -2 * VALUE_SIZE, offset);
+            a.load64(RCX, RBX, -VALUE_SIZE);
+            a.store64(RAX, 0, RCX);
+            a.adjustStack(-2 * VALUE_SIZE);
+            return;
+        case OP_JUMP:
+            jumpTo(a.jump(), ins.operand);
+            return;
+        case OP_JUMP_LT:
+        case OP_JUMP_GT:
+        case OP_JUMP_EQ:
+            a.adjustStack(-2 * VALUE_SIZE);
+            a.load(RAX, RBX, 0);
+            a.compare(RAX, RBX, VALUE_SIZE);
+            jumpTo(a.jumpIf(conditions[ins.op - OP_JUMP_LT]), ins.operand);
+            return;
+        case OP_INC: {
+            const FusedOperands &f = bytecode.fused[ins.operand];
+            exitIfUndefined(f.slot, offset);
+            loadVariable(RAX, f.slot);
+            a.addEaxImmediate(f.step);
+            storeEax(R12, f.slot * VALUE_SIZE);
+            return;
+        }
+        case OP_JUMP_LT_CONST:
+        case OP_JUMP_GT_CONST:
+        case OP_JUMP_EQ_CONST:
+        case OP_JUMP_LT_VAR:
+        case OP_JUMP_GT_VAR:
+        case OP_JUMP_EQ_VAR: {
+            const FusedOperands &f = bytecode.fused[ins.operand];
+            bool isVariable = ins.op >= OP_JUMP_LT_VAR;
+            exitIfUndefined(f.lhs, offset);
+            if (isVariable) exitIfUndefined(f.rhs, offset);
+            compareAndJump(f, isVariable, conditions[(ins.op - OP_JUMP_LT_CONST) % 3]);
+            return;
+        }
+        case OP_INC_JUMP_LT_CONST:
+        case OP_INC_JUMP_GT_CONST:
+        case OP_INC_JUMP_EQ_CONST:
+        case OP_INC_JUMP_LT_VAR:
+        case OP_INC_JUMP_GT_VAR:
+        case OP_INC_JUMP_EQ_VAR: {
+            const FusedOperands &f = bytecode.fused[ins.operand];
+            bool isVariable = ins.op >= OP_INC_JUMP_LT_VAR;
+            exitIfUndefined(f.slot, offset);
+            if (f.lhs != f.slot) exitIfUndefined(f.lhs, offset);
+            if (isVariable && f.rhs != f.slot) exitIfUndefined(f.rhs, offset);
+            loadVariable(RAX, f.slot);
+            a.addEaxImmediate(f.step);
+            storeEax(R12, f.slot * VALUE_SIZE);
+            compareAndJump(f, isVariable, conditions[(ins.op - OP_INC_JUMP_LT_CONST) % 3]);
+            return;
+        }
+        case OP_PUSH_WIDE:
+        case OP_PRINT:
+        case OP_INPUT:
+        case OP_ERROR:
+        case OP_DIM:
+        case OP_HALT:
+            exits.emplace_back(a.jump(), offset);
+            return;
+    }
+}
+
+/*
+ * Implementation notes: compile
+ * -----------------------------
+ * The function saves the registers it uses, loads them from the
+ * JitFrame passed in rdi and falls into the first instruction.  Exit
+ * stubs are shared between all jumps that resume at the same offset,
+ * and all of them finish in one epilogue that stores the operand
+ * stack pointer back into the frame.
+ */
+
+std::vector<unsigned char> LoopCompiler::compile() {
+    a.byte(0x53);                                   /* push rbx    */
+    a.byte(0x41); a.byte(0x54);                     /* push r12    */
+    a.byte(0x41); a.byte(0x55);                     /* push r13    */
+    a.byte(0x41); a.byte(0x56);                     /* push r14    */
+    a.byte(0x49); a.byte(0x89); a.byte(0xFE);       /* mov r14, rdi */
+    a.load64(RBX, R14, offsetof(JitFrame, sp));
+    a.load64(R12, R14, offsetof(JitFrame, values));
+    a.load64(R13, R14, offsetof(JitFrame, defined));
+    for (int offset = start; offset <= end; ++offset) {
+        labels[offset - start] = a.position();
+        compileInstruction(offset, bytecode.code[offset]);
+    }
+    exits.emplace_back(a.jump(), end + 1);
+    std::size_t epilogue = a.position();
+    a.store64(R14, offsetof(JitFrame, sp), RBX);
+    a.byte(0x41); a.byte(0x5E);                     /* pop r14     */
+    a.byte(0x41); a.byte(0x5D);                     /* pop r13     */
+    a.byte(0x41); a.byte(0x5C);                     /* pop r12     */
+    a.byte(0x5B);                                   /* pop rbx     */
+    a.byte(0xC3);                                   /* ret         */
+    std::map<int, std::size_t> stubs;
+    for (const auto &exit : exits) {
+        auto stub = stubs.find(exit.second);
+        if (stub == stubs.end()) {
+            stub = stubs.emplace(exit.second, a.position()).first;
+            a.storeImmediate(R14, offsetof(JitFrame, exitOffset), exit.second);
+            a.patch(a.jump(), epilogue);
+        }
+        a.patch(exit.first, stub->second);
+    }
+    for (const auto &branch : branches) {
+        a.patch(branch.first, labels[branch.second - start]);
+    }
+    return a.code;
+}
+
+}
+
+JitFunction Jit::compile(int start, int end) {
+    std::vector<unsigned char> code = LoopCompiler(bytecode, start, end).compile();
+    void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, code.size());
+        return nullptr;
+    }
+    blocks.emplace_back(memory, code.size());
+    return reinterpret_cast<JitFunction>(memory);
+}
+
+#endif
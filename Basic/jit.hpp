@@ -0,0 +1,121 @@
+/*
+ * File: jit.hpp
+ * -------------
+ * This interface exports the Jit class, an optional tier of the
+ * virtual machine that translates hot loops of bytecode into x86-64
+ * machine code.
+ */
+
+#ifndef _jit_h
+#define _jit_h
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "bytecode.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Macro: BASIC_JIT_SUPPORTED
+ * --------------------------
+ * Nonzero on the platforms the code generator targets.  Elsewhere the
+ * Jit class still compiles but never produces native code, so the
+ * virtual machine simply keeps interpreting.
+ */
+
+#if defined(__x86_64__) && defined(__linux__)
+#define BASIC_JIT_SUPPORTED 1
+#else
+#define BASIC_JIT_SUPPORTED 0
+#endif
+
+/*
+ * Type: JitFrame
+ * --------------
+ * The state shared between the interpreter and native code.  Native
+ * code works directly on the interpreter's operand stack and on the
+ * variable and array tables of the EvalState.  When it returns, sp is the new
+ * top of the operand stack and exitOffset the instruction at which
+ * the interpreter carries on.
+ */
+
+struct JitFrame {
+    Value *sp;
+    Value *values;
+    unsigned char *defined;
+    ArrayRef *arrays;
+    int exitOffset;
+};
+
+typedef void (*JitFunction)(JitFrame *frame);
+
+/*
+ * Class: Jit
+ * ----------
+ * Counts the backward jumps taken while a program runs.  Once the
+ * jumps to some loop head pass a threshold, the instructions from the
+ * head to the jumping instruction are compiled as one native function
+ * entered at the head.  The code implements the 32-bit numeric mode
+ * only: it computes in 32-bit registers and stores every result
+ * sign-extended into the 64-bit Value slots.
+ *
+ * The native code never raises an error and never does I/O.  At
+ * PRINT, INPUT, ERROR, DIM or HALT, at a read of an undefined
+ * variable, at a division by zero, at a subscript outside its array,
+ * and at any jump out of the loop it returns to
+ * the interpreter before executing that instruction, which then runs
+ * it as usual.  Output and error messages are therefore exactly those
+ * of the interpreter.
+ */
+
+class Jit {
+
+public:
+
+/*
+ * Constructor: Jit
+ * Usage: Jit jit(bytecode);
+ * -------------------------
+ * Prepares to compile loops of bytecode, which must outlive the Jit.
+ */
+
+    explicit Jit(const Bytecode &bytecode);
+
+/*
+ * Destructor: ~Jit
+ * ----------------
+ * Frees the native code of every compiled loop.
+ */
+
+    ~Jit();
+
+    Jit(const Jit &) = delete;
+
+    Jit &operator=(const Jit &) = delete;
+
+/*
+ * Method: backEdge
+ * Usage: JitFunction native = jit.backEdge(from, target);
+ * -------------------------------------------------------
+ * Records that the instruction at offset from jumped back to target
+ * and returns the native code to run from target, or nullptr if the
+ * loop is not (yet) compiled.
+ */
+
+    JitFunction backEdge(int from, int target);
+
+private:
+
+    static const int HOT_THRESHOLD = 1000;
+
+    const Bytecode &bytecode;
+    std::vector<int> counters;          /* Back edges taken to each offset */
+    std::vector<JitFunction> entries;   /* Native code entered there       */
+    std::vector<bool> failed;           /* Loops that could not compile    */
+    std::vector<std::pair<void *, std::size_t>> blocks;  /* Mapped code    */
+
+    JitFunction compile(int start, int end);
+
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * File: lexer.cpp
+ * ---------------
+ * Implements the lexer.hpp interface.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include "lexer.hpp"
+#include "sampler.hpp"
+
+
+Lexer::Lexer() : index(0), limit(NO_LIMIT) {
+    setInput(std::string_view());
+}
+
+Lexer::Lexer(std::string_view line) : index(0), limit(NO_LIMIT) {
+    setInput(line);
+}
+
+void Lexer::setInput(std::string_view line) {
+    SamplerPhase phase(PHASE_LEX);
+    source = line;
+    tokens.clear();
+    index = 0;
+    limit = NO_LIMIT;
+    std::size_t i = 0;
+    while (true) {
+        while (i < source.size() && isspace(static_cast<unsigned char>(source[i]))) ++i;
+        if (i == source.size()) break;
+        unsigned char ch = source[i];
+        if (isdigit(ch)) {
+            scanNumber(i);
+        } else if (isalnum(ch)) {
+            std::size_t start = i;
+            while (i < source.size() && isalnum(static_cast<unsigned char>(source[i]))) ++i;
+            tokens.push_back({TOKEN_WORD, int(start), int(i - start), 0});
+        } else {
+            tokens.push_back({TOKEN_OPERATOR, int(i), 1, ch});
+            ++i;
+        }
+    }
+    tokens.push_back({TOKEN_END, int(source.size()), 0, 0});
+}
+
+const Token &Lexer::next() {
+    const Token &token = peek();
+    if (token.kind != TOKEN_END) ++index;
+    return token;
+}
+
+const Token &Lexer::peek() const {
+    return index < limit ? tokens[index] : tokens.back();
+}
+
+bool Lexer::hasMoreTokens() const {
+    return peek().kind != TOKEN_END;
+}
+
+std::string_view Lexer::getText(const Token &token) const {
+    return source.substr(token.offset, token.length);
+}
+
+std::string_view Lexer::getSource() const {
+    return source;
+}
+
+std::size_t Lexer::getPosition() const {
+    return index;
+}
+
+const Token &Lexer::getToken(std::size_t position) const {
+    return position < tokens.size() ? tokens[position] : tokens.back();
+}
+
+void Lexer::setLimit(std::size_t limit) {
+    this->limit = limit;
+}
+
+std::size_t Lexer::getEnd() const {
+    return std::min(limit, tokens.size() - 1);
+}
+
+void Lexer::setPosition(std::size_t position) {
+    index = position;
+}
+
+/*
+ * Implementation notes: scanNumber
+ * --------------------------------
+ * Reads digits, an optional fraction and an optional exponent, which
+ * is the extent of a number for TokenScanner as well.  Only a run of
+ * digits whose value fits the numeric mode becomes a TOKEN_NUMBER.
+ */
+
+void Lexer::scanNumber(std::size_t &i) {
+    std::size_t start = i;
+    long long value = 0;
+    bool inRange = true;
+    while (i < source.size() && isdigit(static_cast<unsigned char>(source[i]))) {
+        if (inRange && (__builtin_mul_overflow(value, 10, &value)
+                        || __builtin_add_overflow(value, source[i] - '0', &value)
+                        || !fitsNumericMode(value))) {
+            inRange = false;
+            value = 0;
+        }
+        ++i;
+    }
+    bool integer = true;
+    if (i < source.size() && source[i] == '.') {
+        integer = false;
+        ++i;
+        while (i < source.size() && isdigit(static_cast<unsigned char>(source[i]))) ++i;
+    }
+    if (i < source.size() && (source[i] == 'e' || source[i] == 'E')) {
+        std::size_t digits = i + 1;
+        if (digits < source.size() && (source[digits] == '+' || source[digits] == '-')) ++digits;
+        if (digits < source.size() && isdigit(static_cast<unsigned char>(source[digits]))) {
+            integer = false;
+            i = digits;
+            while (i < source.size() && isdigit(static_cast<unsigned char>(source[i]))) ++i;
+        }
+    }
+    TokenKind kind = (integer && inRange) ? TOKEN_NUMBER : TOKEN_BAD_NUMBER;
+    tokens.push_back({kind, int(start), int(i - start), inRange ? value : 0});
+}
@@ -0,0 +1,158 @@
+/*
+ * File: lexer.hpp
+ * ---------------
+ * This interface exports the Lexer class, which splits a BASIC line
+ * into tokens for the parser and the statement constructors.
+ */
+
+#ifndef _lexer_h
+#define _lexer_h
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "numeric.hpp"
+
+/*
+ * Type: TokenKind
+ * ---------------
+ * The kinds of token produced by the lexer.  A number that is not a
+ * plain integer in the range of the numeric mode (for example 1.5,
+ * 2e3, or 99999999999 in the default 32-bit mode) is a
+ * TOKEN_BAD_NUMBER, which no statement accepts.
+ */
+
+enum TokenKind {
+    TOKEN_END, TOKEN_WORD, TOKEN_NUMBER, TOKEN_BAD_NUMBER, TOKEN_OPERATOR
+};
+
+/*
+ * Type: Token
+ * -----------
+ * A token is recorded by its position in the source line rather than
+ * as a copy of its text.  For TOKEN_NUMBER the value field holds the
+ * integer already converted; for TOKEN_OPERATOR it holds the operator
+ * character.
+ */
+
+struct Token {
+    TokenKind kind;
+    int offset;
+    int length;
+    Value value;
+};
+
+/*
+ * Class: Lexer
+ * ------------
+ * Tokenizes a whole line at once into a token array that is reused
+ * from one line to the next, and then hands the tokens out in order.
+ * The rules are those of a TokenScanner set to ignoreWhitespace and
+ * scanNumbers: a word is a run of letters and digits starting with a
+ * letter, a number starts with a digit, and every other character is
+ * an operator of its own.  The lexer does not copy the line, which
+ * must outlive it.
+ */
+
+class Lexer {
+
+public:
+
+/*
+ * Constructor: Lexer
+ * Usage: Lexer lexer;
+ *        Lexer lexer(line);
+ * -------------------------
+ * Creates a lexer, optionally tokenizing line straight away.
+ */
+
+    Lexer();
+
+    explicit Lexer(std::string_view line);
+
+/*
+ * Method: setInput
+ * Usage: lexer.setInput(line);
+ * ----------------------------
+ * Tokenizes line, replacing any previous tokens, and moves back to
+ * the first token.
+ */
+
+    void setInput(std::string_view line);
+
+/*
+ * Methods: next, peek, hasMoreTokens
+ * Usage: const Token &token = lexer.next();
+ *        if (lexer.peek().kind == TOKEN_OPERATOR) ...
+ *        if (lexer.hasMoreTokens()) ...
+ * -----------------------------------------------
+ * next returns the current token and advances past it; peek returns
+ * it without advancing.  Past the last token both return a token of
+ * kind TOKEN_END.
+ */
+
+    const Token &next();
+
+    const Token &peek() const;
+
+    bool hasMoreTokens() const;
+
+/*
+ * Methods: getText, getSource
+ * Usage: std::string_view text = lexer.getText(token);
+ * ----------------------------------------------------
+ * Return the text of a token and of the whole line.
+ */
+
+    std::string_view getText(const Token &token) const;
+
+    std::string_view getSource() const;
+
+/*
+ * Methods: getPosition, getToken, setLimit
+ * Usage: std::size_t pos = lexer.getPosition();
+ *        const Token &token = lexer.getToken(pos);
+ *        lexer.setLimit(pos);
+ * ------------------------------------------------
+ * getPosition returns the index of the current token and getToken
+ * looks at any token by index; past the last one it returns the
+ * TOKEN_END token.  setLimit makes the lexer stop before the token at
+ * index limit, as if the line ended there, so that a parser can be
+ * run over part of the line.  setLimit(NO_LIMIT) lifts the limit.
+ */
+
+    static const std::size_t NO_LIMIT = static_cast<std::size_t>(-1);
+
+    std::size_t getPosition() const;
+
+    const Token &getToken(std::size_t position) const;
+
+    void setLimit(std::size_t limit);
+
+/*
+ * Methods: getEnd, setPosition
+ * Usage: std::size_t end = lexer.getEnd();
+ *        lexer.setPosition(pos);
+ * ---------------------------------------
+ * getEnd returns the position at which the tokens run out: that of the
+ * TOKEN_END, or the limit if it comes first.  Together with getToken
+ * they let a client walk the token array by index, and setPosition
+ * moves the lexer to where the client stopped.
+ */
+
+    std::size_t getEnd() const;
+
+    void setPosition(std::size_t position);
+
+private:
+
+    std::string_view source;    /* The line being tokenized         */
+    std::vector<Token> tokens;  /* Its tokens, ending in TOKEN_END  */
+    std::size_t index;          /* Position of the current token    */
+    std::size_t limit;          /* Tokens from here on are hidden   */
+
+    void scanNumber(std::size_t &i);
+
+};
+
+#endif
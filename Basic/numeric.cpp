@@ -0,0 +1,15 @@
+/*
+ * File: numeric.cpp
+ * -----------------
+ * Implements the numeric.hpp interface.
+ */
+
+#include "numeric.hpp"
+#include "Utils/error.hpp"
+
+NumericMode numericMode = NUMERIC_INT32;
+
+void overflowError() {
+    error("INTEGER OVERFLOW");
+    __builtin_unreachable();
+}
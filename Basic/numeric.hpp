@@ -0,0 +1,135 @@
+/*
+ * File: numeric.hpp
+ * -----------------
+ * This interface exports the type that BASIC values are stored in and
+ * the arithmetic of the two numeric modes the interpreter can run in.
+ */
+
+#ifndef _numeric_h
+#define _numeric_h
+
+#include <limits>
+
+/*
+ * Type: Value
+ * -----------
+ * The type of every stored value: variables, constants and operand
+ * stacks.  It is wide enough for either numeric mode.  In the default
+ * mode every Value is in the range of int.
+ */
+
+typedef long long Value;
+
+/*
+ * Type: NumericMode
+ * -----------------
+ * The arithmetic used by every engine:
+ *
+ *   NUMERIC_INT32   32-bit values that wrap around on overflow, as in
+ *                   the reference interpreter (the default)
+ *   NUMERIC_INT64   64-bit values; an operation whose result does not
+ *                   fit raises INTEGER OVERFLOW
+ *
+ * Literals and INPUT values are accepted in the range of the mode.
+ */
+
+enum NumericMode {
+    NUMERIC_INT32, NUMERIC_INT64
+};
+
+/*
+ * Variable: numericMode
+ * ---------------------
+ * The mode in use, NUMERIC_INT64 with the --int64 option.  It is set
+ * before the first line is read and never changes afterwards, since
+ * parsed constants are only checked against the mode once.
+ */
+
+extern NumericMode numericMode;
+
+/*
+ * Function: fitsNumericMode
+ * Usage: if (fitsNumericMode(value)) ...
+ * --------------------------------------
+ * Returns true if value is in the range of the current mode.
+ */
+
+inline bool fitsNumericMode(long long value) {
+    return numericMode == NUMERIC_INT64
+        || (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max());
+}
+
+/*
+ * Function: overflowError
+ * Usage: overflowError();
+ * -----------------------
+ * Raises INTEGER OVERFLOW.  It is out of line and cold, so the checks
+ * below compile to a single branch that is never taken.
+ */
+
+[[noreturn]] __attribute__((cold)) void overflowError();
+
+/*
+ * Type: Arithmetic
+ * ----------------
+ * The four operators on values of type T, which is int for
+ * NUMERIC_INT32 and long long for NUMERIC_INT64.  Each engine's
+ * evaluation loop is a template on T and is instantiated once per
+ * mode; the mode is tested once when the loop is entered.  Division by
+ * zero is left to the caller, which raises DIVIDE BY ZERO before the
+ * operator is applied.
+ */
+
+template <typename T>
+struct Arithmetic;
+
+template <>
+struct Arithmetic<int> {
+
+    static int add(int lhs, int rhs) {
+        return int(unsigned(lhs) + unsigned(rhs));
+    }
+
+    static int subtract(int lhs, int rhs) {
+        return int(unsigned(lhs) - unsigned(rhs));
+    }
+
+    static int multiply(int lhs, int rhs) {
+        return int(unsigned(lhs) * unsigned(rhs));
+    }
+
+    static int divide(int lhs, int rhs) {
+        return rhs == -1 ? int(0u - unsigned(lhs)) : lhs / rhs;  // INT_MIN / -1 回绕而不是陷入
+    }
+
+};
+
+template <>
+struct Arithmetic<long long> {
+
+    static long long add(long long lhs, long long rhs) {
+        long long result;
+        if (__builtin_expect(__builtin_add_overflow(lhs, rhs, &result), 0)) overflowError();
+        return result;
+    }
+
+    static long long subtract(long long lhs, long long rhs) {
+        long long result;
+        if (__builtin_expect(__builtin_sub_overflow(lhs, rhs, &result), 0)) overflowError();
+        return result;
+    }
+
+    static long long multiply(long long lhs, long long rhs) {
+        long long result;
+        if (__builtin_expect(__builtin_mul_overflow(lhs, rhs, &result), 0)) overflowError();
+        return result;
+    }
+
+    static long long divide(long long lhs, long long rhs) {
+        if (__builtin_expect(rhs == -1 && lhs == std::numeric_limits<long long>::min(), 0)) overflowError();
+        return lhs / rhs;
+    }
+
+};
+
+#endif
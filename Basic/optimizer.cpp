@@ -0,0 +1,104 @@
+/*
+ * File: optimizer.cpp
+ * -------------------
+ * Implements the optimizer.hpp interface.
+ */
+
+#include <limits>
+#include "optimizer.hpp"
+
+/*
+ * Implementation notes: fold
+ * --------------------------
+ * Computes lhs op rhs for two known values in the type T of the
+ * numeric mode.  It returns false when the operation would raise
+ * DIVIDE BY ZERO or overflow T, so that the node is kept and behaves
+ * at run time exactly as it did before: it wraps in the 32-bit mode
+ * and raises INTEGER OVERFLOW in the 64-bit one.
+ */
+
+template <typename T>
+static bool fold(Operator op, T lhs, T rhs, T &result) {
+    switch (op) {
+        case ADD:
+            return !__builtin_add_overflow(lhs, rhs, &result);
+        case SUBTRACT:
+            return !__builtin_sub_overflow(lhs, rhs, &result);
+        case MULTIPLY:
+            return !__builtin_mul_overflow(lhs, rhs, &result);
+        case DIVIDE:
+            if (rhs == 0 || (lhs == std::numeric_limits<T>::min() && rhs == -1)) return false;
+            result = lhs / rhs;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool fold(Operator op, Value lhs, Value rhs, Value &result) {
+    if (numericMode == NUMERIC_INT64) return fold<long long>(op, lhs, rhs, result);
+    int value;
+    if (!fold<int>(op, int(lhs), int(rhs), value)) return false;
+    result = value;
+    return true;
+}
+
+static bool isConstant(Expression *exp, Value value) {
+    return isConstant(exp) && ((ConstantExp *) exp)->getValue() == value;
+}
+
+bool isConstant(Expression *exp) {
+    return exp->getType() == CONSTANT;
+}
+
+/*
+ * Implementation notes: simplify
+ * ------------------------------
+ * The tree is simplified bottom-up.  Assignments are never folded
+ * away, since they store a value, but their right-hand side is, and so
+ * is the subscript of an array element.
+ */
+
+Expression *simplify(Expression *exp, Arena &arena) {
+    if (exp->getType() == ARRAY) {
+        ArrayExp *array = (ArrayExp *) exp;
+        Expression *index = simplify(array->getIndex(), arena);
+        if (index == array->getIndex()) return exp;
+        return arena.make<ArrayExp>(array->getName(), index);
+    }
+    if (exp->getType() != COMPOUND) return exp;
+    CompoundExp *compound = (CompoundExp *) exp;
+    Operator op = compound->getOp();
+    Expression *lhs = compound->getLHS();
+    Expression *rhs = simplify(compound->getRHS(), arena);
+    if (op == ASSIGN) {
+        if (rhs == compound->getRHS()) return exp;
+        return arena.make<CompoundExp>(op, lhs, rhs);
+    }
+    lhs = simplify(lhs, arena);
+    Value value;
+    if (isConstant(lhs) && isConstant(rhs)
+        && fold(op, ((ConstantExp *) lhs)->getValue(), ((ConstantExp *) rhs)->getValue(), value)) {
+        return arena.make<ConstantExp>(value);
+    }
+    switch (op) {
+        case ADD:
+            if (isConstant(rhs, 0)) return lhs;
+            if (isConstant(lhs, 0)) return rhs;
+            break;
+        case SUBTRACT:
+            if (isConstant(rhs, 0)) return lhs;
+            break;
+        case MULTIPLY:
+            if (isConstant(rhs, 1)) return lhs;
+            if (isConstant(lhs, 1)) return rhs;
+            break;
+        case DIVIDE:
+            if (isConstant(rhs, 1)) return lhs;
+            break;
+        default:
+            break;
+    }
+    if (lhs == compound->getLHS() && rhs == compound->getRHS()) return exp;
+    return arena.make<CompoundExp>(op, lhs, rhs);
+}
@@ -0,0 +1,41 @@
+/*
+ * File: optimizer.hpp
+ * -------------------
+ * This interface exports the optimization pass that the statements
+ * run over every expression tree produced by parseExp.
+ */
+
+#ifndef _optimizer_h
+#define _optimizer_h
+
+#include "exp.hpp"
+#include "arena.hpp"
+
+/*
+ * Function: simplify
+ * Usage: exp = simplify(exp, arena);
+ * ----------------------------------
+ * Returns an expression equivalent to exp in which constant
+ * subexpressions have been folded and the identities x + 0, 0 + x,
+ * x - 0, x * 1, 1 * x and x / 1 have been reduced to x.  New nodes
+ * are allocated in arena.
+ *
+ * The result raises the same errors as the original, at the same
+ * time: an operation that would divide by zero or overflow is left
+ * in place to fail when it is evaluated, and no operand that could
+ * raise VARIABLE NOT DEFINED is ever dropped (so x * 0 is kept).
+ */
+
+Expression *simplify(Expression *exp, Arena &arena);
+
+/*
+ * Function: isConstant
+ * Usage: if (isConstant(exp)) ...
+ * -------------------------------
+ * Returns true if exp is a constant, which after simplify means its
+ * value is known without evaluating anything.
+ */
+
+bool isConstant(Expression *exp);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ * File: output.cpp
+ * ----------------
+ * Implements the output.hpp interface.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "output.hpp"
+#include "sampler.hpp"
+
+
+/*
+ * Implementation notes: writeAll
+ * ------------------------------
+ * Hands a block of bytes to the kernel, retrying after short writes
+ * and interrupted calls.
+ */
+
+static void writeAll(int fd, const char *text, std::size_t count) {
+    SamplerPhase phase(PHASE_IO);
+    while (count > 0) {
+        ssize_t n = ::write(fd, text, count);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        text += n;
+        count -= n;
+    }
+}
+
+Output::Output(int fd) : fd(fd), lineBuffered(isatty(fd)), length(0) { }
+
+Output::~Output() {
+    flush();
+}
+
+/*
+ * Implementation notes: operator<<(long long)
+ * -------------------------------------------
+ * The digits are produced backwards into a small local array.  Working
+ * on the magnitude as an unsigned value makes the most negative value
+ * come out right.
+ */
+
+Output &Output::operator<<(int value) {
+    return *this << (long long) value;
+}
+
+Output &Output::operator<<(long long value) {
+    writeNumber(value < 0 ? 0ull - (unsigned long long) value : (unsigned long long) value, value < 0);
+    return *this;
+}
+
+Output &Output::operator<<(std::size_t value) {
+    writeNumber(value, false);
+    return *this;
+}
+
+void Output::writeNumber(unsigned long long magnitude, bool negative) {
+    char digits[21];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    do {
+        *--p = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) *--p = '-';
+    write(p, end - p);
+}
+
+Output &Output::operator<<(char ch) {
+    if (length == BUFFER_SIZE) flush();
+    buffer[length++] = ch;
+    if (ch == '\n' && lineBuffered) flush();
+    return *this;
+}
+
+Output &Output::operator<<(const char *str) {
+    write(str, std::strlen(str));
+    return *this;
+}
+
+Output &Output::operator<<(const std::string &str) {
+    write(str.data(), str.length());
+    return *this;
+}
+
+void Output::write(const char *text, std::size_t count) {
+    if (count > BUFFER_SIZE - length) {
+        flush();
+        if (count >= BUFFER_SIZE) {
+            writeAll(fd, text, count);
+            return;
+        }
+    }
+    std::memcpy(buffer + length, text, count);
+    length += count;
+    if (lineBuffered && std::memchr(text, '\n', count) != nullptr) flush();
+}
+
+void Output::flush() {
+    writeAll(fd, buffer, length);
+    length = 0;
+}
+
+Output &output() {
+    static Output standardOutput(STDOUT_FILENO);
+    return standardOutput;
+}
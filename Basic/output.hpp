@@ -0,0 +1,112 @@
+/*
+ * File: output.hpp
+ * ----------------
+ * This interface exports the Output class, through which the
+ * interpreter writes everything it prints.
+ */
+
+#ifndef _output_h
+#define _output_h
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Class: Output
+ * -------------
+ * A block buffer in front of a file descriptor.  Text and integers are
+ * appended to the buffer, integers being formatted by hand, and the
+ * buffer is written out with a single system call when it fills up or
+ * flush is called.  The interpreter flushes before waiting for INPUT,
+ * after printing an error message, at the end of RUN and on QUIT.
+ *
+ * When the descriptor is a terminal the buffer is also flushed at
+ * every newline, so interactive sessions see each line as it is
+ * printed.
+ */
+
+class Output {
+
+public:
+
+/*
+ * Constructor: Output
+ * Usage: Output out(fd);
+ * ----------------------
+ * Creates a buffer that writes to the file descriptor fd.
+ */
+
+    explicit Output(int fd);
+
+/*
+ * Destructor: ~Output
+ * -------------------
+ * Flushes anything still buffered.
+ */
+
+    ~Output();
+
+    Output(const Output &) = delete;
+
+    Output &operator=(const Output &) = delete;
+
+/*
+ * Operator: <<
+ * Usage: out << value << '\n';
+ * ----------------------------
+ * Appends an integer, a character or a string to the buffer.
+ */
+
+    Output &operator<<(int value);
+
+    Output &operator<<(long long value);
+
+    Output &operator<<(std::size_t value);
+
+    Output &operator<<(char ch);
+
+    Output &operator<<(const char *str);
+
+    Output &operator<<(const std::string &str);
+
+/*
+ * Method: write
+ * Usage: out.write(text, length);
+ * -------------------------------
+ * Appends length bytes starting at text to the buffer.
+ */
+
+    void write(const char *text, std::size_t length);
+
+/*
+ * Method: flush
+ * Usage: out.flush();
+ * -------------------
+ * Writes out everything that has been buffered.
+ */
+
+    void flush();
+
+private:
+
+    static const std::size_t BUFFER_SIZE = 1 << 16;
+
+    int fd;                     /* Destination file descriptor       */
+    bool lineBuffered;          /* Flush at every newline (terminal) */
+    std::size_t length;         /* Bytes currently in the buffer     */
+    char buffer[BUFFER_SIZE];
+
+    void writeNumber(unsigned long long magnitude, bool negative);
+
+};
+
+/*
+ * Function: output
+ * Usage: output() << value << '\n';
+ * ---------------------------------
+ * Returns the interpreter's standard output buffer.
+ */
+
+Output &output();
+
+#endif
@@ -7,42 +7,131 @@
 #include "parser.hpp"
 
 
+/*
+ * Implementation notes: operator table
+ * ------------------------------------
+ * Whether a token is a binary operator, and how tightly it binds,
+ * depends only on its kind and, for an operator token, its character.
+ * Both are looked up in one table indexed by that character; every
+ * token that is not an operator uses entry 0, whose precedence of 0
+ * ends any expression.
+ */
+
+struct OperatorEntry {
+    int prec;
+    Operator op;
+};
+
+static const OperatorEntry *operatorTable() {
+    static OperatorEntry table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        table['='] = {1, ASSIGN};
+        table['+'] = {2, ADD};
+        table['-'] = {2, SUBTRACT};
+        table['*'] = {3, MULTIPLY};
+        table['/'] = {3, DIVIDE};
+        initialized = true;
+    }
+    return table;
+}
+
+static inline const OperatorEntry &lookupToken(const Token &token) {
+    static const OperatorEntry *table = operatorTable();
+    return table[token.kind == TOKEN_OPERATOR ? (unsigned char) token.value : 0];
+}
+
+/*
+ * Class: ExpressionReader
+ * -----------------------
+ * Parses over the token array of a lexer by index.  The reader copies
+ * the position and end out of the lexer, so looking at a token is an
+ * array access, and hands the position back when it is done.
+ */
+
+namespace {
+
+class ExpressionReader {
+
+public:
+
+    ExpressionReader(Lexer &lexer, Arena &arena)
+        : lexer(lexer), arena(arena), pos(lexer.getPosition()), end(lexer.getEnd()),
+          tokens(&lexer.getToken(0)) { }
+
+    ~ExpressionReader() {
+        lexer.setPosition(pos);
+    }
+
+    Expression *readE(int prec);
+
+    Expression *readT();
+
+private:
+
+    Lexer &lexer;
+    Arena &arena;
+    std::size_t pos;
+    std::size_t end;
+    const Token *tokens;
+
+    const Token &peek() const {
+        static const Token endToken = {TOKEN_END, 0, 0, 0};
+        return pos < end ? tokens[pos] : endToken;
+    }
+
+    const Token &next() {
+        const Token &token = peek();
+        if (pos < end) ++pos;
+        return token;
+    }
+
+};
+
+}
+
 /*
  * Implementation notes: parseExp
  * ------------------------------
  * This code just reads an expression and then checks for extra tokens.
  */
 
-Expression *parseExp(TokenScanner &scanner) {
-    Expression *exp = readE(scanner);
-    if (scanner.hasMoreTokens()) {
-        error("parseExp: Found extra token: " + scanner.nextToken());
+Expression *parseExp(Lexer &lexer, Arena &arena) {
+    Expression *exp = readE(lexer, arena);
+    if (lexer.hasMoreTokens()) {
+        error("parseExp: Found extra token: " + std::string(lexer.getText(lexer.next())));
     }
     return exp;
 }
 
+Expression *readE(Lexer &lexer, Arena &arena, int prec) {
+    return ExpressionReader(lexer, arena).readE(prec);
+}
+
+Expression *readT(Lexer &lexer, Arena &arena) {
+    return ExpressionReader(lexer, arena).readT();
+}
+
 /*
  * Implementation notes: readE
- * Usage: exp = readE(scanner, prec);
- * ----------------------------------
- * This version of readE uses precedence to resolve the ambiguity in
- * the grammar.  At each recursive level, the parser reads operators and
- * subexpressions until it finds an operator whose precedence is greater
- * than the prevailing one.  When a higher-precedence operator is found,
- * readE calls itself recursively to read in that subexpression as a unit.
+ * Usage: exp = reader.readE(prec);
+ * --------------------------------
+ * Precedence climbing: after a term, operators are consumed as long as
+ * they bind more tightly than prec, and the right operand of each is
+ * read at that operator's own precedence, which makes operators of
+ * equal precedence associate to the left.  The token that ends the
+ * loop is only looked at, so it stays in place for the caller.
  */
 
-Expression *readE(TokenScanner &scanner, int prec) {
-    Expression *exp = readT(scanner);
-    std::string token;
+Expression *ExpressionReader::readE(int prec) {
+    Expression *exp = readT();
     while (true) {
-        token = scanner.nextToken();
-        int newPrec = precedence(token);
-        if (newPrec <= prec) break;
-        Expression *rhs = readE(scanner, newPrec);
-        exp = new CompoundExp(token, exp, rhs);
+        const OperatorEntry &entry = lookupToken(peek());
+        if (entry.prec <= prec) break;
+        ++pos;
+        Expression *rhs = readE(entry.prec);
+        exp = arena.make<CompoundExp>(entry.op, exp, rhs);
     }
-    scanner.saveToken(token);
     return exp;
 }
 
@@ -50,33 +139,34 @@ Expression *readE(TokenScanner &scanner, int prec) {
  * Implementation notes: readT
  * ---------------------------
  * This function scans a term, which is either an integer, an identifier,
- * or a parenthesized subexpression.
+ * an array element or a parenthesized subexpression.  An identifier
+ * directly followed by an opening parenthesis is an array element, and
+ * the parenthesized expression is its subscript.  A leading minus sign
+ * negates the whole expression that follows it, read at precedence 0,
+ * as it always has: -1 + 2 is -(1 + 2).
  */
 
-Expression *readT(TokenScanner &scanner) {
-    std::string token = scanner.nextToken();
-    TokenType type = scanner.getTokenType(token);
-    if (type == WORD) return new IdentifierExp(token);
-    if (type == NUMBER) return new ConstantExp(stringToInteger(token));
-    if (token == "-") return new CompoundExp(token, new ConstantExp(0), readE(scanner));
-    if (token != "(") error("Illegal term in expression");
-    Expression *exp = readE(scanner);
-    if (scanner.nextToken() != ")") {
+Expression *ExpressionReader::readT() {
+    const Token &token = next();
+    if (token.kind == TOKEN_WORD) {
+        std::string name(lexer.getText(token));
+        if (peek().kind != TOKEN_OPERATOR || peek().value != '(') return arena.make<IdentifierExp>(name);
+        ++pos;
+        Expression *index = readE(0);
+        const Token &close = next();
+        if (close.kind != TOKEN_OPERATOR || close.value != ')') {
+            error("Unbalanced parentheses in expression");
+        }
+        return arena.make<ArrayExp>(name, index);
+    }
+    if (token.kind == TOKEN_NUMBER) return arena.make<ConstantExp>(token.value);
+    if (token.kind != TOKEN_OPERATOR) error("Illegal term in expression");
+    if (token.value == '-') return arena.make<CompoundExp>(SUBTRACT, arena.make<ConstantExp>(0), readE(0));
+    if (token.value != '(') error("Illegal term in expression");
+    Expression *exp = readE(0);
+    const Token &close = next();
+    if (close.kind != TOKEN_OPERATOR || close.value != ')') {
         error("Unbalanced parentheses in expression");
     }
     return exp;
 }
-
-/*
- * Implementation notes: precedence
- * --------------------------------
- * This function checks the token against each of the defined operators
- * and returns the appropriate precedence value.
- */
-
-int precedence(std::string token) {
-    if (token == "=") return 1;
-    if (token == "+" || token == "-") return 2;
-    if (token == "*" || token == "/") return 3;
-    return 0;
-}
@@ -10,52 +10,43 @@
 #include <string>
 #include <iostream>
 #include "exp.hpp"
+#include "arena.hpp"
+#include "lexer.hpp"
 
-#include "Utils/tokenScanner.hpp"
 #include "Utils/error.hpp"
 #include "Utils/strlib.hpp"
 
 
 /*
  * Function: parseExp
- * Usage: Expression *exp = parseExp(scanner);
- * -------------------------------------------
- * Parses an expression by reading tokens from the scanner, which must
- * be provided by the client.  The scanner should be set to ignore
- * whitespace and to scan numbers.
+ * Usage: Expression *exp = parseExp(lexer, arena);
+ * ------------------------------------------------
+ * Parses an expression from the remaining tokens of the lexer, which
+ * must be provided by the client.  The nodes of the expression are
+ * allocated in arena, which also reclaims them if parsing fails.
  */
 
-Expression *parseExp(TokenScanner &scanner);
+Expression *parseExp(Lexer &lexer, Arena &arena);
 
 /*
  * Function: readE
- * Usage: Expression *exp = readE(scanner, prec);
- * ----------------------------------------------
- * Returns the next expression from the scanner involving only operators
+ * Usage: Expression *exp = readE(lexer, arena, prec);
+ * ---------------------------------------------------
+ * Returns the next expression from the lexer involving only operators
  * whose precedence is at least prec.  The prec argument is optional and
  * defaults to 0, which means that the function reads the entire expression.
  */
 
-Expression *readE(TokenScanner &scanner, int prec = 0);
+Expression *readE(Lexer &lexer, Arena &arena, int prec = 0);
 
 /*
  * Function: readT
- * Usage: Expression *exp = readT(scanner);
- * ----------------------------------------
+ * Usage: Expression *exp = readT(lexer, arena);
+ * ---------------------------------------------
  * Returns the next individual term, which is either a constant, an
- * identifier, or a parenthesized subexpression.
+ * identifier, an array element, or a parenthesized subexpression.
  */
 
-Expression *readT(TokenScanner &scanner);
-
-/*
- * Function: precedence
- * Usage: int prec = precedence(token);
- * ------------------------------------
- * Returns the precedence of the specified operator token.  If the token
- * is not an operator, precedence returns 0.
- */
-
-int precedence(std::string token);
+Expression *readT(Lexer &lexer, Arena &arena);
 
 #endif
@@ -0,0 +1,187 @@
+/*
+ * File: postfix.cpp
+ * -----------------
+ * Implements the postfix.hpp interface.
+ */
+
+#include <cstring>
+#include <vector>
+#include "postfix.hpp"
+
+
+/*
+ * Implementation notes: flatten
+ * -----------------------------
+ * Emits the instructions of exp in the order CompoundExp::eval
+ * evaluates the tree.  An operator whose right operand is a leaf takes
+ * that leaf as its operand; the leaf is still read after the left side
+ * and before the operator is applied, as in eval.  An assignment does
+ * not evaluate its left side, and one that eval would reject becomes a
+ * POSTFIX_ERROR in place of the whole assignment, so the error is
+ * raised at the same point.  depth tracks the stack height, counting
+ * POSTFIX_ERROR as a push.
+ */
+
+static void flatten(Expression *exp, std::vector<PostfixInstruction> &code, int &depth, int &maxDepth) {
+    switch (exp->getType()) {
+        case CONSTANT:
+            code.push_back({POSTFIX_CONSTANT, ((ConstantExp *) exp)->getValue()});
+            break;
+        case IDENTIFIER:
+            code.push_back({POSTFIX_LOAD, ((IdentifierExp *) exp)->getSlot()});
+            break;
+        case ARRAY:
+            flatten(((ArrayExp *) exp)->getIndex(), code, depth, maxDepth);
+            code.push_back({POSTFIX_ELEMENT, ((ArrayExp *) exp)->getSlot()});
+            return;
+        case COMPOUND: {
+            CompoundExp *compound = (CompoundExp *) exp;
+            Expression *lhs = compound->getLHS();
+            Expression *rhs = compound->getRHS();
+            Operator op = compound->getOp();
+            if (op == ASSIGN) {
+                static const int letSlot = EvalState::getSlot("LET");
+                if (lhs->getType() != IDENTIFIER) {
+                    code.push_back({POSTFIX_ERROR, 0});
+                } else if (((IdentifierExp *) lhs)->getSlot() == letSlot) {
+                    code.push_back({POSTFIX_ERROR, 1});
+                } else {
+                    flatten(rhs, code, depth, maxDepth);
+                    code.push_back({POSTFIX_ASSIGN, ((IdentifierExp *) lhs)->getSlot()});
+                    return;
+                }
+                break;
+            }
+            int offset = op - ADD;
+            flatten(lhs, code, depth, maxDepth);
+            if (rhs->getType() == CONSTANT) {
+                code.push_back({PostfixOp(POSTFIX_ADD_CONSTANT + offset), ((ConstantExp *) rhs)->getValue()});
+            } else if (rhs->getType() == IDENTIFIER) {
+                code.push_back({PostfixOp(POSTFIX_ADD_LOAD + offset), ((IdentifierExp *) rhs)->getSlot()});
+            } else {
+                flatten(rhs, code, depth, maxDepth);
+                code.push_back({PostfixOp(POSTFIX_ADD + offset), 0});
+                --depth;
+            }
+            return;
+        }
+    }
+    if (++depth > maxDepth) maxDepth = depth;
+}
+
+PostfixExp::PostfixExp() : tree(nullptr), code(nullptr), length(0) { }
+
+PostfixExp::PostfixExp(Expression *exp, Arena &arena) : tree(exp), code(nullptr), length(0) {
+    static std::vector<PostfixInstruction> buffer;
+    buffer.clear();
+    int depth = 0;
+    int maxDepth = 0;
+    flatten(exp, buffer, depth, maxDepth);
+    if (maxDepth > MAX_DEPTH) return;
+    std::size_t bytes = buffer.size() * sizeof(PostfixInstruction);
+    void *memory = arena.allocate(bytes, alignof(PostfixInstruction));
+    std::memcpy(memory, buffer.data(), bytes);
+    code = static_cast<const PostfixInstruction *>(memory);
+    length = int(buffer.size());
+}
+
+/*
+ * Implementation notes: run
+ * -------------------------
+ * The same stack discipline as the virtual machine, except that the
+ * top of the stack is kept in a local variable and only the values
+ * below it live in the array.  The checks and messages are those of
+ * IdentifierExp::eval and CompoundExp::eval, and the loop is
+ * instantiated for the type of each numeric mode.
+ */
+
+template <typename T>
+static inline T load(const EvalState &state, int slot) {
+    if (!state.isDefined(slot)) error("VARIABLE NOT DEFINED");
+    return T(state.getValue(slot));
+}
+
+template <typename T>
+static inline T divide(T left, T right) {
+    if (right == 0) error("DIVIDE BY ZERO");
+    return Arithmetic<T>::divide(left, right);
+}
+
+Value PostfixExp::run(EvalState &state) const {
+    if (code == nullptr) return tree->eval(state);
+    if (numericMode == NUMERIC_INT64) return run<long long>(state);
+    return run<int>(state);
+}
+
+template <typename T>
+T PostfixExp::run(EvalState &state) const {
+    T stack[MAX_DEPTH];
+    T *sp = stack;
+    T top = 0;
+    for (const PostfixInstruction *ins = code, *end = code + length; ins != end; ++ins) {
+        switch (ins->op) {
+            case POSTFIX_CONSTANT:
+                *sp++ = top;
+                top = T(ins->operand);
+                break;
+            case POSTFIX_LOAD:
+                *sp++ = top;
+                top = load<T>(state, ins->operand);
+                break;
+            case POSTFIX_ADD:
+                top = Arithmetic<T>::add(sp[-1], top);
+                --sp;
+                break;
+            case POSTFIX_SUBTRACT:
+                top = Arithmetic<T>::subtract(sp[-1], top);
+                --sp;
+                break;
+            case POSTFIX_MULTIPLY:
+                top = Arithmetic<T>::multiply(sp[-1], top);
+                --sp;
+                break;
+            case POSTFIX_DIVIDE:
+                top = divide<T>(sp[-1], top);
+                --sp;
+                break;
+            case POSTFIX_ADD_CONSTANT:
+                top = Arithmetic<T>::add(top, T(ins->operand));
+                break;
+            case POSTFIX_SUBTRACT_CONSTANT:
+                top = Arithmetic<T>::subtract(top, T(ins->operand));
+                break;
+            case POSTFIX_MULTIPLY_CONSTANT:
+                top = Arithmetic<T>::multiply(top, T(ins->operand));
+                break;
+            case POSTFIX_DIVIDE_CONSTANT:
+                top = divide<T>(top, T(ins->operand));
+                break;
+            case POSTFIX_ADD_LOAD:
+                top = Arithmetic<T>::add(top, load<T>(state, ins->operand));
+                break;
+            case POSTFIX_SUBTRACT_LOAD:
+                top = Arithmetic<T>::subtract(top, load<T>(state, ins->operand));
+                break;
+            case POSTFIX_MULTIPLY_LOAD:
+                top = Arithmetic<T>::multiply(top, load<T>(state, ins->operand));
+                break;
+            case POSTFIX_DIVIDE_LOAD:
+                top = divide<T>(top, load<T>(state, ins->operand));
+                break;
+            case POSTFIX_ELEMENT:
+                top = T(state.getElement(int(ins->operand), top));
+                break;
+            case POSTFIX_ASSIGN:
+                state.setValue(int(ins->operand), top);
+                break;
+            case POSTFIX_ERROR:
+                error(ins->operand == 0 ? "Illegal variable in assignment" : "SYNTAX ERROR");
+                break;
+        }
+    }
+    return top;
+}
+
+Expression *PostfixExp::getTree() const {
+    return tree;
+}
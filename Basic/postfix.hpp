@@ -0,0 +1,127 @@
+/*
+ * File: postfix.hpp
+ * -----------------
+ * This interface exports the PostfixExp class, a flat encoding of an
+ * expression tree that statements evaluate instead of walking the
+ * tree.
+ */
+
+#ifndef _postfix_h
+#define _postfix_h
+
+#include "arena.hpp"
+#include "exp.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Type: PostfixOp
+ * ---------------
+ * The operations of the postfix form, each one byte:
+ *
+ *   POSTFIX_CONSTANT            push the constant operand
+ *   POSTFIX_LOAD                push the variable in slot operand
+ *   POSTFIX_ADD ...             pop rhs and lhs, push lhs op rhs
+ *   POSTFIX_ADD_CONSTANT ...    replace the top x by x op operand
+ *   POSTFIX_ADD_LOAD ...        replace the top x by x op the variable
+ *                               in slot operand
+ *   POSTFIX_ELEMENT             replace the top x by element x of the
+ *                               array in slot operand
+ *   POSTFIX_ASSIGN              store the top in slot operand
+ *   POSTFIX_ERROR               raise the error of an invalid assignment
+ *
+ * The _CONSTANT and _LOAD forms stand for an operator whose right
+ * operand is a single constant or variable, the common case, and save
+ * one push and pop each.  The four operators of each group are in the
+ * order of the Operator type, starting at ADD.
+ */
+
+enum PostfixOp : unsigned char {
+    POSTFIX_CONSTANT, POSTFIX_LOAD,
+    POSTFIX_ADD, POSTFIX_SUBTRACT, POSTFIX_MULTIPLY, POSTFIX_DIVIDE,
+    POSTFIX_ADD_CONSTANT, POSTFIX_SUBTRACT_CONSTANT, POSTFIX_MULTIPLY_CONSTANT, POSTFIX_DIVIDE_CONSTANT,
+    POSTFIX_ADD_LOAD, POSTFIX_SUBTRACT_LOAD, POSTFIX_MULTIPLY_LOAD, POSTFIX_DIVIDE_LOAD,
+    POSTFIX_ELEMENT, POSTFIX_ASSIGN, POSTFIX_ERROR
+};
+
+struct PostfixInstruction {
+    PostfixOp op;
+    Value operand;
+};
+
+/*
+ * Class: PostfixExp
+ * -----------------
+ * The instructions of an expression in postfix order, stored as one
+ * array in the arena of the statement that owns the expression.
+ * Evaluating them gives the same value and raises the same errors, in
+ * the same order, as calling eval on the tree, which is kept for
+ * toString and for the bytecode compiler.
+ */
+
+class PostfixExp {
+
+public:
+
+/*
+ * Constructor: PostfixExp
+ * Usage: PostfixExp code(exp, arena);
+ * -----------------------------------
+ * Flattens exp into arena.  The default constructor leaves the
+ * object empty until one is assigned to it.
+ */
+
+    PostfixExp();
+
+    PostfixExp(Expression *exp, Arena &arena);
+
+/*
+ * Method: eval
+ * Usage: Value value = code.eval(state);
+ * --------------------------------------
+ * Evaluates the expression on an operand stack of MAX_DEPTH entries
+ * in a local array.  An expression that would need a deeper stack is
+ * not flattened and is evaluated on its tree instead.
+ */
+
+    Value eval(EvalState &state) const;
+
+/*
+ * Method: getTree
+ * Usage: Expression *exp = code.getTree();
+ * ----------------------------------------
+ * Returns the tree this code was made from.
+ */
+
+    Expression *getTree() const;
+
+    static const int MAX_DEPTH = 32;
+
+private:
+
+    Expression *tree;
+    const PostfixInstruction *code;     /* nullptr if not flattened */
+    int length;
+
+    Value run(EvalState &state) const;
+
+    template <typename T>
+    T run(EvalState &state) const;
+
+};
+
+/*
+ * Implementation notes: eval
+ * --------------------------
+ * Most expressions in a program are a single constant or variable, so
+ * those are handled inline without entering the evaluation loop.
+ */
+
+inline Value PostfixExp::eval(EvalState &state) const {
+    if (length == 1) {
+        if (code->op == POSTFIX_CONSTANT) return code->operand;
+        if (code->op == POSTFIX_LOAD && state.isDefined(code->operand)) return state.getValue(code->operand);
+    }
+    return run(state);
+}
+
+#endif
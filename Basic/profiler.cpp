@@ -0,0 +1,81 @@
+/*
+ * File: profiler.cpp
+ * ------------------
+ * Implements the profiler.hpp interface.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "profiler.hpp"
+#include "output.hpp"
+
+
+Profiler *Profiler::active = nullptr;
+
+Profiler::Profiler() {
+    active = this;
+}
+
+Profiler::~Profiler() {
+    if (active == this) active = nullptr;
+}
+
+void Profiler::enterLine(int lineNumber) {
+    current = &lines[lineNumber];
+    ++current->count;
+    start = Clock::now();
+}
+
+void Profiler::leaveLine() {
+    current->time += Clock::now() - start;
+}
+
+Value Profiler::evaluate(const PostfixExp &exp, EvalState &state) {
+    Clock::time_point begin = Clock::now();
+    Value value = exp.eval(state);
+    if (current != nullptr) current->expression += Clock::now() - begin;
+    return value;
+}
+
+Value evaluateInstrumented(const PostfixExp &exp, EvalState &state) {
+    SamplerPhase phase(PHASE_EVAL);
+    if (Profiler::active == nullptr) return exp.eval(state);
+    return Profiler::active->evaluate(exp, state);
+}
+
+/*
+ * Implementation notes: printReport
+ * ---------------------------------
+ * Times are printed in milliseconds with three decimals.  A statement
+ * that raised an error is counted but its partial time is not, since
+ * leaveLine never ran for it.
+ */
+
+void Profiler::printReport() const {
+    std::vector<std::pair<int, const LineProfile *>> rows;
+    long long statements = 0;
+    Clock::duration total{0};
+    for (const auto &line : lines) {
+        rows.emplace_back(line.first, &line.second);
+        statements += line.second.count;
+        total += line.second.time;
+    }
+    std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+        if (a.second->time != b.second->time) return a.second->time > b.second->time;
+        return a.first < b.first;
+    });
+    auto millis = [](Clock::duration d) {
+        return std::chrono::duration<double, std::milli>(d).count();
+    };
+    char buffer[128];
+    std::snprintf(buffer, sizeof(buffer), "PROFILE: %lld STATEMENTS, %.3f MS\n", statements, millis(total));
+    output() << buffer;
+    output() << "    LINE       COUNT     TIME MS      EXP MS   TIME %\n";
+    for (const auto &row : rows) {
+        double percent = total.count() == 0 ? 0 : 100.0 * row.second->time.count() / total.count();
+        std::snprintf(buffer, sizeof(buffer), "%8d %11lld %11.3f %11.3f %7.1f%%\n", row.first, row.second->count,
+                      millis(row.second->time), millis(row.second->expression), percent);
+        output() << buffer;
+    }
+}
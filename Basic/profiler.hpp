@@ -0,0 +1,118 @@
+/*
+ * File: profiler.hpp
+ * ------------------
+ * This interface exports the Profiler class, which records where the
+ * time goes while the PROFILE command runs a program.
+ */
+
+#ifndef _profiler_h
+#define _profiler_h
+
+#include <chrono>
+#include <unordered_map>
+#include "postfix.hpp"
+#include "evalstate.hpp"
+#include "sampler.hpp"
+
+/*
+ * Class: Profiler
+ * ---------------
+ * Collects, for every line number, how often its statement ran, the
+ * time spent in it and the part of that time spent evaluating its
+ * expressions.  PROFILE runs the program one statement at a time,
+ * calling enterLine and leaveLine around each statement, and while a
+ * Profiler is active the statements evaluate their expressions
+ * through it (see evaluate below).
+ */
+
+class Profiler {
+
+public:
+
+/*
+ * Constructor: Profiler
+ * Usage: Profiler profiler;
+ * -------------------------
+ * Creates a profiler and makes it the active one until it is
+ * destroyed.
+ */
+
+    Profiler();
+
+    ~Profiler();
+
+    Profiler(const Profiler &) = delete;
+
+    Profiler &operator=(const Profiler &) = delete;
+
+/*
+ * Methods: enterLine, leaveLine
+ * Usage: profiler.enterLine(lineNumber);
+ *        profiler.leaveLine();
+ * -------------------------------------
+ * Bracket the execution of the statement on lineNumber.
+ */
+
+    void enterLine(int lineNumber);
+
+    void leaveLine();
+
+/*
+ * Method: evaluate
+ * Usage: Value value = profiler.evaluate(exp, state);
+ * ---------------------------------------------------
+ * Evaluates exp and charges the time to the current line.
+ */
+
+    Value evaluate(const PostfixExp &exp, EvalState &state);
+
+/*
+ * Method: printReport
+ * Usage: profiler.printReport();
+ * ------------------------------
+ * Prints one row per line that ran, the most expensive first.
+ */
+
+    void printReport() const;
+
+/*
+ * Variable: active
+ * ----------------
+ * The profiler of the running PROFILE command, or nullptr.
+ */
+
+    static Profiler *active;
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct LineProfile {
+        long long count = 0;
+        Clock::duration time{0};          /* Whole statement        */
+        Clock::duration expression{0};    /* Expression evaluation  */
+    };
+
+    std::unordered_map<int, LineProfile> lines;
+    LineProfile *current = nullptr;
+    Clock::time_point start;
+
+};
+
+/*
+ * Function: evaluate
+ * Usage: Value value = evaluate(exp, state);
+ * ------------------------------------------
+ * Evaluates exp, through the active profiler if there is one, and in
+ * the eval phase of the sampler if it is running.  This is what
+ * statements call, so that a run with neither pays only two tests.
+ */
+
+Value evaluateInstrumented(const PostfixExp &exp, EvalState &state);
+
+inline Value evaluate(const PostfixExp &exp, EvalState &state) {
+    if (Profiler::active == nullptr && !Sampler::enabled) return exp.eval(state);
+    return evaluateInstrumented(exp, state);
+}
+
+#endif
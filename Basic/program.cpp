@@ -8,107 +8,235 @@
  * the performance guarantees specified in the assignment.
  */
 
+#include <algorithm>
 #include "program.hpp"
+#include "output.hpp"
 
 
-Program::Program() : currentLineNumber(-1) { }
+Program::Program() : current(-1), cursor(0) { }
 
 Program::~Program() {
     clear();
 }
 
 void Program::clear() {
-    for(auto &entry:parsedStatements) {
-        delete entry.second;
+    for (Line &line : lines) {
+        StatementCache::release(line.parsed);
     }
-    parsedStatements.clear();
-    sourceLines.clear();
-    currentLineNumber = -1;
+    lines.clear();
+    referrers.clear();
+    current = -1;
+    cursor = 0;
 }
 
+/*
+ * Implementation notes: addSourceLine
+ * -----------------------------------
+ * Lines usually arrive in increasing order, in which case the new
+ * line is simply appended.  A line inserted in the middle moves the
+ * lines after it, so the jump indices pointing past it are shifted.
+ * Either way, every line that was waiting to jump to this number now
+ * gets its index.
+ */
+
 void Program::addSourceLine(int lineNumber, const std::string &line) {
-    if (sourceLines.count(lineNumber)) {
-        delete parsedStatements[lineNumber];
-        parsedStatements.erase(lineNumber);
-        sourceLines[lineNumber] = line;
+    int index = findLine(lineNumber);
+    if (index != -1) {
+        unlinkTarget(index);
+        StatementCache::release(lines[index].parsed);
+        lines[index].stmt = nullptr;
+        lines[index].parsed = nullptr;
+        lines[index].source = line;
+        return;
     }
-    else {
-        sourceLines[lineNumber] = line;
+    index = lowerBound(lineNumber);
+    lines.insert(lines.begin() + index, Line{lineNumber, line, nullptr, nullptr, -1});
+    shiftTargets(index, 1);
+    auto waiting = referrers.find(lineNumber);
+    if (waiting != referrers.end()) {
+        for (int referrer : waiting->second) {
+            lines[findLine(referrer)].target = index;
+        }
     }
+    cursor = index;
 }
 
 void Program::removeSourceLine(int lineNumber) {
-    sourceLines.erase(lineNumber);
-    delete parsedStatements[lineNumber];
-    parsedStatements.erase(lineNumber);
+    int index = findLine(lineNumber);
+    if (index == -1) return;
+    unlinkTarget(index);
+    auto waiting = referrers.find(lineNumber);
+    if (waiting != referrers.end()) {
+        for (int referrer : waiting->second) {
+            lines[findLine(referrer)].target = -1;
+        }
+    }
+    StatementCache::release(lines[index].parsed);
+    lines.erase(lines.begin() + index);
+    if (current == index) current = -1;
+    shiftTargets(index, -1);
+    cursor = 0;
 }
 
 std::string Program::getSourceLine(int lineNumber) {
-    if (sourceLines.find(lineNumber) != sourceLines.end()) {
-        return sourceLines[lineNumber];
-    }
-    else {
-        return "";
-    }
+    int index = findLine(lineNumber);
+    return index == -1 ? "" : lines[index].source;
 }
 
-void Program::setParsedStatement(int lineNumber, Statement *stmt) {
-    if (sourceLines.find(lineNumber) == sourceLines.end()) {
+void Program::setParsedStatement(int lineNumber, CachedStatement *parsed) {
+    int index = findLine(lineNumber);
+    if (index == -1) {
+        StatementCache::release(parsed);
         throw std::runtime_error("Error: Line number does not exist.");
     }
-    else {
-        delete parsedStatements[lineNumber];
-        parsedStatements.erase(lineNumber);
-        parsedStatements[lineNumber] = stmt;
+    unlinkTarget(index);
+    StatementCache::release(lines[index].parsed);
+    lines[index].stmt = parsed->stmt;
+    lines[index].parsed = parsed;
+    int targetLine = parsed->stmt->getTargetLine();
+    if (targetLine != -1) {
+        referrers[targetLine].push_back(lineNumber);
+        lines[index].target = findLine(targetLine);
     }
 }
 
-//void Program::removeSourceLine(int lineNumber) {
-
 Statement *Program::getParsedStatement(int lineNumber) {
-    if (sourceLines.find(lineNumber) == sourceLines.end()) {
-        return nullptr;
-    }
-    else {
-        return parsedStatements[lineNumber];
-    }
+    int index = findLine(lineNumber);
+    return index == -1 ? nullptr : lines[index].stmt;
 }
 
 int Program::getFirstLineNumber() {
-    if (sourceLines.empty()) {
+    if (lines.empty()) {
         return -1;
     }
     else {
-        return sourceLines.begin() -> first;
+        cursor = 0;
+        return lines.front().number;
     }
 }
 
+/*
+ * Implementation notes: getNextLineNumber
+ * ---------------------------------------
+ * Walking the program with getFirstLineNumber and getNextLineNumber
+ * always asks for the line after the one found last, which the cursor
+ * answers in constant time.  Other queries fall back to a binary
+ * search.
+ */
+
 int Program::getNextLineNumber(int lineNumber) {
-    if (sourceLines.empty()) return -1;
-    auto it = sourceLines.upper_bound(lineNumber);
-    if (it != sourceLines.end()) {
-        return it->first;
+    int index;
+    if (cursor < int(lines.size()) && lines[cursor].number == lineNumber) {
+        index = cursor + 1;
     } else {
-        return -1;
+        index = int(std::upper_bound(lines.begin(), lines.end(), lineNumber,
+                                     [](int number, const Line &line) { return number < line.number; })
+                    - lines.begin());
     }
+    if (index >= int(lines.size())) return -1;
+    cursor = index;
+    return lines[index].number;
 }
 
 int Program::getCurrentLineNumber() {
-    return currentLineNumber;
+    return current == -1 ? -1 : lines[current].number;
 }
 
 
 void Program::setCurrentLineNumber(int lineNumber) {
-    currentLineNumber = lineNumber;
+    current = lineNumber == -1 ? -1 : findLine(lineNumber);
+}
+
+Statement *Program::getCurrentStatement() {
+    return current == -1 ? nullptr : lines[current].stmt;
 }
 
 void Program::printAllLines() const {
-    for (const auto& entry : sourceLines) {
-        std::cout << entry.first << " " << entry.second << '\n';
+    for (const Line &line : lines) {
+        output() << line.number << ' ' << line.source << '\n';
     }
 }
 
 void Program::goToNextLine() {
-    if (currentLineNumber == -1) return;
-    currentLineNumber = getNextLineNumber(currentLineNumber);
+    if (current == -1) return;
+    if (++current == int(lines.size())) current = -1;
+}
+
+/*
+ * Implementation notes: jumpTo
+ * ----------------------------
+ * During RUN the jumping statement is on the current line, whose
+ * target index is already resolved.  Only a stale or missing link
+ * falls back to a search, which then decides LINE NUMBER ERROR.
+ */
+
+void Program::jumpTo(int lineNumber) {
+    int target = current == -1 ? -1 : lines[current].target;
+    if (target == -1 || lines[target].number != lineNumber) {
+        target = findLine(lineNumber);
+    }
+    if (target == -1) {
+        error("LINE NUMBER ERROR");
+    }
+    current = target;
+}
+
+int Program::findLine(int lineNumber) {
+    if (cursor < int(lines.size()) && lines[cursor].number == lineNumber) {
+        return cursor;
+    }
+    int index = lowerBound(lineNumber);
+    if (index == int(lines.size()) || lines[index].number != lineNumber) return -1;
+    cursor = index;
+    return index;
+}
+
+int Program::lowerBound(int lineNumber) const {
+    return int(std::lower_bound(lines.begin(), lines.end(), lineNumber,
+                                [](const Line &line, int number) { return line.number < number; })
+               - lines.begin());
+}
+
+/*
+ * Implementation notes: shiftTargets
+ * ----------------------------------
+ * Adjusts the jump indices after lines have moved: every target at
+ * or beyond from moves by delta, and a target equal to from after a
+ * removal is left for the caller, which has already cleared it.
+ * Appending at the end moves nothing and costs nothing.
+ */
+
+void Program::shiftTargets(int from, int delta) {
+    int last = int(lines.size()) - (delta > 0 ? 1 : 0);
+    if (from >= last) return;
+    for (Line &line : lines) {
+        if (line.target >= from) line.target += delta;
+    }
+    if (current >= from) current += delta;
+}
+
+/*
+ * Implementation notes: unlinkTarget
+ * ----------------------------------
+ * Removes a line from the referrer list of the line its statement
+ * jumps to, before that statement is replaced or deleted.
+ */
+
+void Program::unlinkTarget(int index) {
+    Line &line = lines[index];
+    line.target = -1;
+    if (line.stmt == nullptr) return;
+    int targetLine = line.stmt->getTargetLine();
+    if (targetLine == -1) return;
+    auto waiting = referrers.find(targetLine);
+    if (waiting == referrers.end()) return;
+    std::vector<int> &list = waiting->second;
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (list[i] == line.number) {
+            list[i] = list.back();
+            list.pop_back();
+            break;
+        }
+    }
+    if (list.empty()) referrers.erase(waiting);
 }
@@ -10,9 +10,11 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <set>
 #include <unordered_map>
 #include "statement.hpp"
+#include "statementcache.hpp"
 
 
 class Statement;
@@ -28,6 +30,12 @@ class Statement;
  *
  * 2. The parsed representation of that statement, which is a
  *    pointer to a Statement.
+ *
+ * The lines live in a single array sorted by line number, so that
+ * stepping to the next line is an increment and LIST is a linear
+ * scan.  Lines that jump also record the index of their target
+ * line.  These indices are patched whenever a line is added or
+ * removed, so a running program never has to search for a line.
  */
 
 class Program {
@@ -98,15 +106,16 @@ public:
 
 /*
  * Method: setParsedStatement
- * Usage: program.setParsedStatement(lineNumber, stmt);
- * ----------------------------------------------------
+ * Usage: program.setParsedStatement(lineNumber, parsed);
+ * ------------------------------------------------------
  * Adds the parsed representation of the statement to the statement
- * at the specified line number.  If no such line exists, this
- * method raises an error.  If a previous parsed representation
- * exists, the memory for that statement is reclaimed.
+ * at the specified line number.  The program takes over the cache
+ * reference held by the caller.  If no such line exists, this method
+ * raises an error.  If a previous parsed representation exists, its
+ * reference is released.
  */
 
-    void setParsedStatement(int lineNumber, Statement *stmt);
+    void setParsedStatement(int lineNumber, CachedStatement *parsed);
 
 /*
  * Method: getParsedStatement
@@ -140,18 +149,82 @@ public:
 
     int getNextLineNumber(int lineNumber);
 
+/*
+ * Methods: getCurrentLineNumber, setCurrentLineNumber
+ * Usage: int lineNumber = program.getCurrentLineNumber();
+ *        program.setCurrentLineNumber(lineNumber);
+ * ------------------------------------------------------
+ * Get and set the line being executed.  -1 stands for no line,
+ * which is how a running program stops.
+ */
+
     int getCurrentLineNumber();
 
     void setCurrentLineNumber(int lineNumber);//设置当前行
 
+/*
+ * Method: getCurrentStatement
+ * Usage: Statement *stmt = program.getCurrentStatement();
+ * -------------------------------------------------------
+ * Returns the parsed statement of the current line, or NULL if the
+ * program has stopped.
+ */
+
+    Statement *getCurrentStatement();
+
     void printAllLines()const;
 
+/*
+ * Method: goToNextLine
+ * Usage: program.goToNextLine();
+ * ------------------------------
+ * Moves the current line on to its successor.
+ */
+
     void goToNextLine();
 
+/*
+ * Method: jumpTo
+ * Usage: program.jumpTo(lineNumber);
+ * ----------------------------------
+ * Makes lineNumber the current line, raising LINE NUMBER ERROR if
+ * there is no such line.  When called from the statement on the
+ * current line this follows the precomputed jump link.
+ */
+
+    void jumpTo(int lineNumber);
+
 private:
-    std::map<int, Statement*>parsedStatements;//按顺序存储行号到语句的映射
-    std::map<int,std::string>sourceLines;//按顺序储存行号到源代码的映射
-    int currentLineNumber;//当前正在处理的行
+
+/*
+ * Private type: Line
+ * ------------------
+ * A stored program line.  stmt is the statement held by parsed, a
+ * reference into the statement cache that the line owns, and may be
+ * shared with other lines.  target is the index of the line that the statement jumps to, or -1
+ * if it does not jump or that line does not exist.
+ */
+
+    struct Line {
+        int number;
+        std::string source;
+        Statement *stmt;
+        CachedStatement *parsed;
+        int target;
+    };
+
+    std::vector<Line> lines;//按行号排序的所有行
+    std::unordered_map<int, std::vector<int>> referrers;//跳转到每个行号的行号
+    int current;//当前正在处理的行的下标
+    int cursor;//最近一次查找到的行的下标
+
+    int findLine(int lineNumber);
+
+    int lowerBound(int lineNumber) const;
+
+    void shiftTargets(int from, int delta);
+
+    void unlinkTarget(int index);
 };
 
 #endif
@@ -0,0 +1,138 @@
+/*
+ * File: sampler.cpp
+ * -----------------
+ * Implements the sampler.hpp interface.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sys/time.h>
+#include "sampler.hpp"
+
+
+bool Sampler::enabled = false;
+volatile sig_atomic_t Sampler::phase = PHASE_INTERPRETER;
+volatile sig_atomic_t Sampler::line = -1;
+const Instruction *volatile Sampler::pc = nullptr;
+
+/*
+ * Implementation notes: sample table
+ * ----------------------------------
+ * The signal handler may not allocate, so the counts live in a fixed
+ * open-addressing table keyed by (line, phase).  Samples that find the
+ * table full are only counted as dropped.  The bytecode pointers are
+ * written before pc is set and are not touched while pc is non-null.
+ */
+
+static const int TABLE_SIZE = 1 << 14;
+
+struct SampleEntry {
+    int line;
+    int phase;
+    long count;
+};
+
+static SampleEntry table[TABLE_SIZE];
+static long droppedSamples = 0;
+static FILE *outputFile = nullptr;
+static const Instruction *bytecodeStart = nullptr;
+static const int *bytecodeLines = nullptr;
+
+static const char *const PHASE_NAMES[] = {
+    "interpreter", "lex", "parse", "compile", "execute", "eval", "io", "vm", "native"
+};
+
+static int classify(OpCode op) {
+    switch (op) {
+        case OP_PUSH:
+        case OP_PUSH_WIDE:
+        case OP_LOAD:
+        case OP_LOAD_ELEMENT:
+        case OP_DUP:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            return PHASE_EVAL;
+        case OP_PRINT:
+        case OP_INPUT:
+            return PHASE_IO;
+        default:
+            return PHASE_EXECUTE;
+    }
+}
+
+static void recordSample(int signal) {
+    int currentPhase = Sampler::phase;
+    int currentLine = Sampler::line;
+    const Instruction *current = Sampler::pc;
+    if (current != nullptr) {
+        currentLine = bytecodeLines[current - bytecodeStart];
+        if (currentPhase == PHASE_VM) currentPhase = classify(current->op);
+    }
+    unsigned hash = (unsigned(currentLine) * 2654435761u) ^ unsigned(currentPhase);
+    for (int probe = 0; probe < TABLE_SIZE; ++probe) {
+        SampleEntry &entry = table[(hash + probe) & (TABLE_SIZE - 1)];
+        if (entry.count == 0) {
+            entry.line = currentLine;
+            entry.phase = currentPhase;
+        }
+        if (entry.line == currentLine && entry.phase == currentPhase) {
+            ++entry.count;
+            return;
+        }
+    }
+    ++droppedSamples;
+}
+
+static void writeReport() {
+    itimerval off = {};
+    setitimer(ITIMER_PROF, &off, nullptr);
+    FILE *file = outputFile;
+    for (const SampleEntry &entry : table) {
+        if (entry.count == 0) continue;
+        if (entry.line < 0) {
+            std::fprintf(file, "basic;interpreter;%s %ld\n", PHASE_NAMES[entry.phase], entry.count);
+        } else {
+            std::fprintf(file, "basic;line %d;%s %ld\n", entry.line, PHASE_NAMES[entry.phase], entry.count);
+        }
+    }
+    if (droppedSamples > 0) std::fprintf(file, "basic;dropped %ld\n", droppedSamples);
+    std::fclose(file);
+}
+
+/*
+ * Implementation notes: start
+ * ---------------------------
+ * The report file is opened here rather than at exit, so that a path
+ * that cannot be written is reported before the program runs.
+ */
+
+bool Sampler::start(const std::string &path) {
+    outputFile = std::fopen(path.c_str(), "w");
+    if (outputFile == nullptr) return false;
+    struct sigaction action = {};
+    action.sa_handler = recordSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    itimerval timer = {};
+    timer.it_interval.tv_usec = 1000;
+    timer.it_value.tv_usec = 1000;
+    if (sigaction(SIGPROF, &action, nullptr) != 0 || setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        std::fclose(outputFile);
+        outputFile = nullptr;
+        return false;
+    }
+    enabled = true;
+    std::atexit(writeReport);
+    return true;
+}
+
+SamplerBytecode::SamplerBytecode(const Bytecode &bytecode) : phase(PHASE_VM) {
+    bytecodeStart = bytecode.code.data();
+    bytecodeLines = bytecode.lines.data();
+}
+
+SamplerBytecode::~SamplerBytecode() {
+    Sampler::pc = nullptr;
+}
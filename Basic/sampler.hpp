@@ -0,0 +1,124 @@
+/*
+ * File: sampler.hpp
+ * -----------------
+ * This interface exports the Sampler class, a statistical profiler
+ * that records, on every SIGPROF tick, which BASIC line is running
+ * and what the interpreter is doing for it.
+ */
+
+#ifndef _sampler_h
+#define _sampler_h
+
+#include <csignal>
+#include <string>
+#include "bytecode.hpp"
+
+/*
+ * Type: SamplePhase
+ * -----------------
+ * What the interpreter is busy with.  PHASE_VM stands for "running
+ * bytecode": a sample taken in it is charged to eval, io or execute
+ * according to the instruction being dispatched, and to that
+ * instruction's line.  PHASE_NATIVE is code generated by the JIT.
+ */
+
+enum SamplePhase {
+    PHASE_INTERPRETER, PHASE_LEX, PHASE_PARSE, PHASE_COMPILE,
+    PHASE_EXECUTE, PHASE_EVAL, PHASE_IO, PHASE_VM, PHASE_NATIVE
+};
+
+/*
+ * Class: Sampler
+ * --------------
+ * The interpreter keeps the public variables below up to date as it
+ * works; they are plain stores, so they cost next to nothing when no
+ * sampling is going on.  Once start is called, an ITIMER_PROF timer
+ * raises SIGPROF every millisecond of CPU time and the handler counts
+ * one sample for the current (line, phase) pair in a fixed table.  At
+ * exit the counts are written as folded stacks, one per line:
+ *
+ *     basic;line 30;eval 1234
+ *     basic;interpreter;parse 56
+ *
+ * which flamegraph.pl and similar tools read directly.
+ */
+
+class Sampler {
+
+public:
+
+/*
+ * Method: start
+ * Usage: Sampler::start(path);
+ * ----------------------------
+ * Starts sampling.  The report is written to path when the process
+ * exits.  Returns false if path cannot be opened for writing or the
+ * timer could not be set up.
+ */
+
+    static bool start(const std::string &path);
+
+    static bool enabled;                            /* start was called      */
+    static volatile sig_atomic_t phase;             /* A SamplePhase         */
+    static volatile sig_atomic_t line;              /* Statement being run   */
+    static const Instruction *volatile pc;          /* Instruction being run */
+
+};
+
+/*
+ * Class: SamplerPhase
+ * -------------------
+ * Sets the sampler phase for the lifetime of the object and then
+ * restores the previous one.
+ */
+
+class SamplerPhase {
+
+public:
+
+    explicit SamplerPhase(SamplePhase phase) : saved(Sampler::phase) {
+        Sampler::phase = phase;
+    }
+
+    ~SamplerPhase() {
+        Sampler::phase = saved;
+    }
+
+    SamplerPhase(const SamplerPhase &) = delete;
+
+    SamplerPhase &operator=(const SamplerPhase &) = delete;
+
+private:
+
+    sig_atomic_t saved;
+
+};
+
+/*
+ * Class: SamplerBytecode
+ * ----------------------
+ * Marks a run of the virtual machine for the lifetime of the object.
+ * While it lasts the virtual machine publishes the instruction it is
+ * dispatching in Sampler::pc, whose line is looked up in the line
+ * table of the bytecode.
+ */
+
+class SamplerBytecode {
+
+public:
+
+    explicit SamplerBytecode(const Bytecode &bytecode);
+
+    ~SamplerBytecode();
+
+    SamplerBytecode(const SamplerBytecode &) = delete;
+
+    SamplerBytecode &operator=(const SamplerBytecode &) = delete;
+
+private:
+
+    SamplerPhase phase;
+
+};
+
+#endif
@@ -7,12 +7,18 @@
  * BASIC statements.
  */
 
+#include <cctype>
+#include <cstdlib>
 #include "statement.hpp"
+#include "compiler.hpp"
+#include "optimizer.hpp"
+#include "input.hpp"
+#include "output.hpp"
+#include "profiler.hpp"
+#include "threaded.hpp"
 
 
 /* Implementation of the Statement class */
-bool check(const char op, const int lhs, const int rhs);
-int stringToInt(std::string str);
 bool isKeyword(const std::string &var);//检查是否是关键字
 bool isValidIdentifier(const std::string &var);//检查变量名称是否合法
 bool isVaribleValid(const std::string &var);//验证变量名是否正确
@@ -21,252 +27,404 @@ Statement::Statement() = default;
 
 Statement::~Statement() = default;
 
+int Statement::getTargetLine() const {
+    return -1;
+}
+
+
+/*
+ * Implementation notes: readExpression
+ * ------------------------------------
+ * Parses the remaining tokens of the lexer as an expression and runs
+ * the simplify pass over it.  Any problem found by the parser is
+ * reported as a SYNTAX ERROR, which is the only message the interpreter
+ * prints for malformed lines.
+ */
 
- REM::REM() = default;
-REM::REM(const std::string& input) {
-    str_line = input;
+static Expression *readExpression(Lexer &lexer, Arena &arena) {
+    try {
+        return simplify(parseExp(lexer, arena), arena);
+    } catch (ErrorException &ex) {
+        error("SYNTAX ERROR");
+    }
+    return nullptr;
 }
-REM::~REM() = default;
-void REM::execute(EvalState &state, Program &program) {
-    program.goToNextLine();//处于注释状态的时候，移动到下一行
+
+/*
+ * Implementation notes: readLineNumber
+ * ------------------------------------
+ * Reads the target of a GOTO or IF ... THEN, which must be a plain
+ * line number.
+ */
+
+static int readLineNumber(Lexer &lexer) {
+    const Token &token = lexer.next();
+    if (token.kind != TOKEN_NUMBER) {
+        error("SYNTAX ERROR");
+    }
+    return token.value;
 }
 
+/*
+ * Implementation notes: readKeyword
+ * ---------------------------------
+ * Consumes the next token and checks that it is the given keyword.
+ */
 
- LET::LET() = default;
-LET::LET(const std::string& input) {
-    str_line = input;
+static void readKeyword(Lexer &lexer, std::string_view keyword) {
+    const Token &token = lexer.next();
+    if (token.kind != TOKEN_WORD || lexer.getText(token) != keyword) {
+        error("SYNTAX ERROR");
+    }
 }
-LET::~LET() = default;
-void LET::execute(EvalState &state, Program &program) {
-    TokenScanner scanner(str_line);
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
 
-    if (scanner.nextToken() != "LET") {
+/*
+ * Implementation notes: readSubscript
+ * -----------------------------------
+ * Reads a parenthesized subscript.  The matching parenthesis is found
+ * first and the lexer is limited to the tokens before it, as IF does
+ * for its two sides, so the expression parser sees only the subscript.
+ */
+
+static Expression *readSubscript(Lexer &lexer, Arena &arena) {
+    const Token &open = lexer.next();
+    if (open.kind != TOKEN_OPERATOR || open.value != '(') {
         error("SYNTAX ERROR");
     }
-    std::string var = scanner.nextToken();
+    std::size_t closeIndex = lexer.getPosition();
+    for (int depth = 0; ; ++closeIndex) {
+        const Token &token = lexer.getToken(closeIndex);
+        if (token.kind == TOKEN_END) {
+            error("SYNTAX ERROR");
+        }
+        if (token.kind != TOKEN_OPERATOR) continue;
+        if (token.value == '(') ++depth;
+        if (token.value == ')' && depth-- == 0) break;
+    }//找到配对的右括号
+    lexer.setLimit(closeIndex);
+    Expression *subscript = readExpression(lexer, arena);
+    lexer.setLimit(Lexer::NO_LIMIT);
+    lexer.next();
+    return subscript;
+}
+
+
+REM::REM(Lexer &lexer, Arena &arena) { }
+REM::~REM() = default;
+void REM::execute(EvalState &state, Program &program) {
+    program.goToNextLine();//处于注释状态的时候，移动到下一行
+}
+void REM::compile(Compiler &compiler) { }
+void REM::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runRem;
+}
+
+
+LET::LET(Lexer &lexer, Arena &arena) : slot(-1), exp(nullptr), index(nullptr) {
+    readKeyword(lexer, "LET");
+    std::string var(lexer.getText(lexer.next()));
     if (!isVaribleValid(var)) {
         error("SYNTAX ERROR");
     }//验证变量名的合法性
-    if (scanner.nextToken() != "=") {
+    slot = EvalState::getSlot(var);
+    if (lexer.peek().kind == TOKEN_OPERATOR && lexer.peek().value == '(') {
+        index = readSubscript(lexer, arena);//数组元素
+        indexCode = PostfixExp(index, arena);
+    }
+    const Token &assign = lexer.next();
+    if (assign.kind != TOKEN_OPERATOR || assign.value != '=') {
         error("SYNTAX ERROR");
     }
-    Expression *exp = nullptr;
-    try {
-        exp = parseExp(scanner);//解析等号右边的表达式
-        int value = exp->eval(state);
-        state.setValue(var, value);
-    } catch (...) {
-        delete exp;
-        throw;
+    exp = readExpression(lexer, arena);//解析等号右边的表达式
+    code = PostfixExp(exp, arena);
+}
+LET::~LET() = default;
+void LET::execute(EvalState &state, Program &program) {
+    if (index) {
+        Value position = evaluate(indexCode, state);//先求下标，再求右边
+        Value value = evaluate(code, state);
+        state.setElement(slot, position, value);
+    } else {
+        Value value = evaluate(code, state);
+        state.setValue(slot, value);
     }
-    delete exp;
     program.goToNextLine();
 }
+void LET::compile(Compiler &compiler) {
+    if (index) {
+        compiler.compileExp(index);
+        compiler.compileExp(exp);
+        compiler.emit(OP_STORE_ELEMENT, slot);
+        return;
+    }
+    compiler.compileAssignment(slot, exp);
+}
+void LET::thread(ThreadedOp &op) const {
+    op.handler = index ? ThreadedCode::runLetElement : ThreadedCode::runLet;
+    op.slot = slot;
+    op.lhs = code;
+    op.rhs = indexCode;
+}
 
 
 
- PRINT::PRINT() = default;
-PRINT::PRINT(const std::string& input) {
-    str_line = input;
+PRINT::PRINT(Lexer &lexer, Arena &arena) : exp(nullptr) {
+    readKeyword(lexer, "PRINT");
+    exp = readExpression(lexer, arena);
+    code = PostfixExp(exp, arena);
 }
 PRINT::~PRINT() = default;
 void PRINT::execute(EvalState &state, Program &program) {
-    TokenScanner scanner(str_line);
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    if (scanner.nextToken() != "PRINT") {
-        error("SYNTAX ERROR");
-    }
-    Expression *expr = nullptr;
-    try {
-        expr = parseExp(scanner);
-        if (scanner.hasMoreTokens()) {
-            delete expr; // 确保释放内存
-            error("SYNTAX ERROR");
-        }
-        int value = expr->eval(state);
-        std::cout << value << std::endl;
-    } catch (...) {
-        delete expr;
-        throw;
-    }
-    delete expr;
+    Value value = evaluate(code, state);
+    output() << value << '\n';
     program.goToNextLine();
 }
+void PRINT::compile(Compiler &compiler) {
+    compiler.compileExp(exp);
+    compiler.emit(OP_PRINT);
+}
+void PRINT::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runPrint;
+    op.lhs = code;
+}
 
 
- GOTO::GOTO() =default;
-GOTO::GOTO(const std::string& input) {
-    str_line = input;
+GOTO::GOTO(Lexer &lexer, Arena &arena) {
+    readKeyword(lexer, "GOTO");
+    targetLine = readLineNumber(lexer);
+    if (lexer.hasMoreTokens()) {
+        error("SYNTAX ERROR");
+    }
 }
 GOTO::~GOTO() = default;
 void GOTO::execute(EvalState &state, Program &program) {
-    TokenScanner scanner(str_line);
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    if (scanner.nextToken() != "GOTO") {
-        error("SYNTAX ERROR");
-        program.goToNextLine();
-    }
-    int targetLine;
-    try {
-        std::string lineToken = scanner.nextToken();
-        targetLine = stringToInt(lineToken);
-    } catch (...) {
+    program.jumpTo(targetLine);//不存在目标行时报错
+}
+void GOTO::compile(Compiler &compiler) {
+    compiler.emitJump(OP_JUMP, targetLine);
+}
+void GOTO::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runGoto;
+    op.targetLine = targetLine;
+}
+int GOTO::getTargetLine() const {
+    return targetLine;
+}
+
+
+INPUT::INPUT(Lexer &lexer, Arena &arena) {
+    readKeyword(lexer, "INPUT");
+    std::string var(lexer.getText(lexer.next()));
+    if (!isVaribleValid(var)) {
         error("SYNTAX ERROR");
     }
-    if (program.getSourceLine(targetLine).empty()) {
-        error("LINE NUMBER ERROR");
-        program.goToNextLine();
-        return;
-    }//不存在目标行
-    if (scanner.hasMoreTokens()) {
+    slot = EvalState::getSlot(var);
+    if (lexer.hasMoreTokens()) {
         error("SYNTAX ERROR");
     }
-    program.setCurrentLineNumber(targetLine);
-}
-
-
- INPUT::INPUT() =default;
-INPUT::INPUT(const std::string& input) {
-    str_line = input;
 }
 INPUT::~INPUT() = default;
 void INPUT::execute(EvalState &state, Program &program) {
-    TokenScanner scanner(str_line);
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(str_line);
-    if (scanner.nextToken() != "INPUT") {
-        error("SYNTAX ERROR");
-    }
-    std::string var = scanner.nextToken();
+    state.setValue(slot, readInputValue());
+    program.goToNextLine();
+}
+void INPUT::compile(Compiler &compiler) {
+    compiler.emit(OP_INPUT, slot);
+}
+void INPUT::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runInput;
+    op.slot = slot;
+}
+
+
+DIM::DIM(Lexer &lexer, Arena &arena) : slot(-1), bound(nullptr) {
+    readKeyword(lexer, "DIM");
+    std::string var(lexer.getText(lexer.next()));
     if (!isVaribleValid(var)) {
         error("SYNTAX ERROR");
     }
-    if (scanner.hasMoreTokens()) {
+    slot = EvalState::getSlot(var);
+    bound = readSubscript(lexer, arena);
+    if (lexer.hasMoreTokens()) {
         error("SYNTAX ERROR");
     }
-    std::cout << " ? ";
-    int value;
-    while (true) {
-        std::cin >> value;
-        if (std::cin.fail()) {
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cout << "INVALID NUMBER" << '\n' << " ? ";
-            continue;
-        }
-        char extra;
-        if (std::cin.get(extra) && extra != '\n') {
-            std::cin.clear();
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            std::cout << "INVALID NUMBER" << '\n' << " ? ";
-            continue;
-        }
-        break;
-    }
-    state.setValue(var, value);
+    boundCode = PostfixExp(bound, arena);
+}
+DIM::~DIM() = default;
+void DIM::execute(EvalState &state, Program &program) {
+    state.dimension(slot, evaluate(boundCode, state));
     program.goToNextLine();
 }
+void DIM::compile(Compiler &compiler) {
+    compiler.compileExp(bound);
+    compiler.emit(OP_DIM, slot);
+}
+void DIM::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runDim;
+    op.slot = slot;
+    op.lhs = boundCode;
+}
 
 
- END::END() = default;
-END::END(const std::string& input) {
-    str_line = input;
+END::END(Lexer &lexer, Arena &arena) {
+    readKeyword(lexer, "END");
+    if (lexer.hasMoreTokens()) {
+        error("SYNTAX ERROR");
+    }
 }
 END::~END() = default;
 void END::execute(EvalState &state, Program &program) {
     program.setCurrentLineNumber(-1);
 }
+void END::compile(Compiler &compiler) {
+    compiler.emit(OP_HALT);
+}
+void END::thread(ThreadedOp &op) const {
+    op.handler = ThreadedCode::runEnd;
+}
+
 
+/*
+ * Implementation notes: IF
+ * ------------------------
+ * The tokens are split at the first relational operator and at the
+ * THEN keyword that follows it, and the lexer is limited to each part
+ * in turn while that side is parsed.  The split is found before either
+ * side is parsed so that = is never read as an assignment there.  Both
+ * sides are parsed here once and flattened to postfix code, so execute
+ * only evaluates the two sides and jumps.  When both sides fold to
+ * constants the outcome is decided here as well.
+ */
 
- IF::IF() = default;
-IF::IF(const std::string& input) {
-    str_line = input;
+static bool isRelationalOperator(const Token &token) {
+    return token.kind == TOKEN_OPERATOR && (token.value == '=' || token.value == '<' || token.value == '>');
 }
-IF::~IF() = default;
-void IF::execute(EvalState &state, Program &program) {
-    std::string tempLine = str_line;
-    tempLine = tempLine.substr(3);
-    int op = 0;
-    while (tempLine[op] != '=' && tempLine[op] != '<' && tempLine[op] != '>') {
-        ++op;
+
+IF::IF(Lexer &lexer, Arena &arena) : lhs(nullptr), rhs(nullptr), op('='), targetLine(-1), knownResult(-1) {
+    readKeyword(lexer, "IF");
+    std::size_t opIndex = lexer.getPosition();
+    while (lexer.getToken(opIndex).kind != TOKEN_END && !isRelationalOperator(lexer.getToken(opIndex))) {
+        ++opIndex;
     }//找到比较运算符
-    std::string lh = tempLine.substr(0, op);//表达式的左边部分
-    TokenScanner lhsExpre;
-    lhsExpre.ignoreWhitespace();
-    lhsExpre.scanNumbers();
-    lhsExpre.setInput(lh);
-    Expression *lhsExp = parseExp(lhsExpre);//解析左值
-    int lhs = lhsExp->eval(state);
-    delete lhsExp;
-    int end = op + 1;
-    while (tempLine[end] == ' ') ++end;
-    while (end < tempLine.length() && tempLine[end] != 'T' && tempLine[end] != '=' && tempLine[end] != '<' && tempLine[end] != '>') {
-        ++end;
-    }
-    if (end == tempLine.length() || tempLine[end] == '=' || tempLine[end] == '<' || tempLine[end] == '>') {
+    if (lexer.getToken(opIndex).kind == TOKEN_END) {
         error("SYNTAX ERROR");
-    }//比较运算符之后没有内容
-    --end;
-    std::string rhsString = tempLine.substr(op + 1, end - op - 1);
-    TokenScanner rhsScanner;
-    rhsScanner.ignoreWhitespace();
-    rhsScanner.scanNumbers();
-    rhsScanner.setInput(rhsString);
-    Expression *rhsExp = parseExp(rhsScanner);
-    int rhs = rhsExp->eval(state);
-    delete rhsExp;
-    if (check(tempLine[op], lhs, rhs)) {
-        tempLine = tempLine.substr(end + 1);
-        TokenScanner scanner;
-        scanner.ignoreWhitespace();
-        scanner.scanNumbers();
-        scanner.setInput(tempLine);
-        if (scanner.nextToken() != "THEN") {
+    }
+    std::size_t thenIndex = opIndex + 1;
+    while (true) {
+        const Token &token = lexer.getToken(thenIndex);
+        if (token.kind == TOKEN_END || isRelationalOperator(token)) {
             error("SYNTAX ERROR");
-        } else {
-            std::string token = scanner.nextToken();
-            int lineNumber = stringToInt(token);
-            if (scanner.hasMoreTokens()) {
-                error("SYNTAX ERROR");
-            }
-            if (program.getSourceLine(lineNumber).empty()) {
-                error("LINE NUMBER ERROR");
-            } else {
-                program.setCurrentLineNumber(lineNumber); // 跳转到目标行
-            }
         }
+        if (token.kind == TOKEN_WORD && lexer.getText(token) == "THEN") break;
+        ++thenIndex;
+    }//找到 THEN
+    lexer.setLimit(opIndex);
+    lhs = readExpression(lexer, arena);//表达式的左边部分
+    lexer.setLimit(Lexer::NO_LIMIT);
+    op = char(lexer.next().value);
+    lexer.setLimit(thenIndex);
+    rhs = readExpression(lexer, arena);
+    lexer.setLimit(Lexer::NO_LIMIT);
+    readKeyword(lexer, "THEN");
+    targetLine = readLineNumber(lexer);
+    if (lexer.hasMoreTokens()) {
+        error("SYNTAX ERROR");
+    }
+    lhsCode = PostfixExp(lhs, arena);
+    rhsCode = PostfixExp(rhs, arena);
+    if (isConstant(lhs) && isConstant(rhs)) {
+        knownResult = check(op, ((ConstantExp *) lhs)->getValue(), ((ConstantExp *) rhs)->getValue());
+    }
+}
+IF::~IF() = default;
+void IF::execute(EvalState &state, Program &program) {
+    bool result;
+    if (knownResult != -1) {
+        result = knownResult;
+    } else {
+        Value lhsValue = evaluate(lhsCode, state);
+        Value rhsValue = evaluate(rhsCode, state);
+        result = check(op, lhsValue, rhsValue);
+    }
+    if (result) {
+        program.jumpTo(targetLine); // 跳转到目标行
     } else {
         program.goToNextLine();
     }
 }
+void IF::compile(Compiler &compiler) {
+    if (knownResult != -1) {
+        if (knownResult) compiler.emitJump(OP_JUMP, targetLine);
+        return;
+    }
+    compiler.compileCondition(op, lhs, rhs, targetLine);
+}
+void IF::thread(ThreadedOp &op) const {
+    if (knownResult == 0) {
+        op.handler = ThreadedCode::runRem;//条件恒假，直接落到下一行
+        return;
+    }
+    op.handler = knownResult == 1 ? ThreadedCode::runGoto : ThreadedCode::runIf;
+    op.targetLine = targetLine;
+    op.relation = this->op;
+    op.lhs = lhsCode;
+    op.rhs = rhsCode;
+}
+int IF::getTargetLine() const {
+    return targetLine;
+}
 
 
 
 
-int stringToInt(std::string s) {
-    int sign = 1;
-    int num = 0;
-    if (s[0] == '-') {
-        sign = -1;
-        s = s.substr(1);
+/*
+ * Implementation notes: readInputValue
+ * ------------------------------------
+ * Values are read from the same buffered reader as the command lines,
+ * following the rules of std::cin >> int: blank lines are skipped,
+ * the value is an optional sign and digits that fit the numeric mode,
+ * and it must be followed directly by the end of the line.  Any other line
+ * is rejected as a whole.  Running out of input here ends the session,
+ * since no value can ever arrive.
+ */
+
+static bool parseInputLine(std::string_view line, bool &blank, Value &value) {
+    std::size_t i = 0;
+    while (i < line.size() && isspace(static_cast<unsigned char>(line[i]))) ++i;
+    blank = (i == line.size());
+    if (blank) return false;
+    bool negative = false;
+    if (line[i] == '+' || line[i] == '-') negative = (line[i++] == '-');
+    if (i == line.size() || !isdigit(static_cast<unsigned char>(line[i]))) return false;
+    Value result = 0;
+    while (i < line.size() && isdigit(static_cast<unsigned char>(line[i]))) {
+        int digit = line[i++] - '0';
+        if (__builtin_mul_overflow(result, 10, &result)
+            || __builtin_add_overflow(result, negative ? -digit : digit, &result)
+            || !fitsNumericMode(result)) return false;
     }
-    for(char i:s) {
-        if (i < '0' || i > '9') {
-            error("INVALID NUMBER");
-        }
-        else {
-            num = num * 10 + i - '0';
-        }
+    if (i != line.size()) return false;//数字后还有多余字符
+    value = result;
+    return true;
+}
+
+Value readInputValue() {
+    output() << " ? ";
+    output().flush();
+    std::string_view line;
+    while (input().readLine(line)) {
+        bool blank;
+        Value value;
+        if (parseInputLine(line, blank, value)) return value;
+        if (blank) continue;
+        output() << "INVALID NUMBER" << '\n' << " ? ";
+        output().flush();
     }
-    return num;
+    output().flush();
+    exit(0);
 }
 
-bool check(const char op, const int lhs, const int rhs) {
+bool check(const char op, const Value lhs, const Value rhs) {
     if (op == '<') {
         return lhs < rhs;
     }
@@ -282,8 +440,8 @@ bool check(const char op, const int lhs, const int rhs) {
 
 bool isKeyword(const std::string &var) {
     static const std::unordered_set<std::string> keywords = {
-        "REM", "LET", "PRINT", "INPUT", "END", "GOTO",
-        "IF", "THEN", "RUN", "LIST", "CLEAR", "QUIT", "HELP"
+        "REM", "LET", "PRINT", "INPUT", "END", "GOTO", "DIM",
+        "IF", "THEN", "RUN", "LIST", "CLEAR", "QUIT", "HELP", "STATS", "PROFILE"
     };
     return keywords.count(var) > 0;
 }
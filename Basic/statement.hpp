@@ -18,13 +18,17 @@
 #include <limits>
 #include "evalstate.hpp"
 #include "exp.hpp"
-#include "Utils/tokenScanner.hpp"
+#include "postfix.hpp"
+#include "lexer.hpp"
 #include "program.hpp"
 #include "parser.hpp"
+#include "arena.hpp"
 #include "Utils/error.hpp"
 #include "Utils/strlib.hpp"
 
 class Program;
+class Compiler;
+struct ThreadedOp;
 
 /*
  * Class: Statement
@@ -51,11 +55,10 @@ public:
 
 /*
  * Destructor: ~Statement
- * Usage: delete stmt;
- * -------------------
- * The destructor deallocates the storage for this expression.
- * It must be declared virtual to ensure that the correct subclass
- * destructor is called when deleting a statement.
+ * ----------------------
+ * Statements are allocated in the Arena of their line, which runs this
+ * destructor when the line is replaced, removed or cleared.  It must
+ * be declared virtual so that the arena destroys the right subclass.
  */
 
     virtual ~Statement();
@@ -72,8 +75,37 @@ public:
  */
 
     virtual void execute(EvalState &state, Program &program) = 0;
-protected:
-    std::string str_line;//当前行正在解析的内容
+
+/*
+ * Method: compile
+ * Usage: stmt->compile(compiler);
+ * -------------------------------
+ * Emits the bytecode for this statement.  The code must behave
+ * exactly like execute, including which errors it raises and when.
+ */
+
+    virtual void compile(Compiler &compiler) = 0;
+
+/*
+ * Method: thread
+ * Usage: stmt->thread(op);
+ * ------------------------
+ * Fills in the handler and operands of the ThreadedOp for this
+ * statement's line (see threaded.hpp), and the line number it jumps
+ * to, if any.  The handler must behave exactly like execute.
+ */
+
+    virtual void thread(ThreadedOp &op) const = 0;
+
+/*
+ * Method: getTargetLine
+ * Usage: int lineNumber = stmt->getTargetLine();
+ * ----------------------------------------------
+ * Returns the line number this statement may jump to, or -1 if it
+ * never jumps.  Program uses it to keep jump links up to date.
+ */
+
+    virtual int getTargetLine() const;
 };
 
 
@@ -81,65 +113,131 @@ protected:
  * The remainder of this file must consists of subclass
  * definitions for the individual statement forms.  Each of
  * those subclasses must define a constructor that parses a
- * statement from a scanner and a method called execute,
- * which executes that statement.  If the private data for
- * a subclass includes data allocated on the heap (such as
- * an Expression object), the class implementation must also
- * specify its own destructor method to free that memory.
+ * statement from a lexer and a method called execute,
+ * which executes that statement.  Expression objects used by
+ * a subclass are allocated in the same arena as the statement
+ * and must not be deleted by its destructor.
+ *
+ * Each constructor parses and validates its line completely, so
+ * a malformed statement raises SYNTAX ERROR when the line is
+ * entered and execute only has to evaluate the parsed form.
  */
 class REM: public Statement {
 public:
-    REM();//默认构造函数
-    explicit REM (const std::string &input);//字符串构造函数
+    explicit REM (Lexer &lexer, Arena &arena);//字符串构造函数
     ~REM() override;//析构函数
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
 };
 
 class LET: public Statement {
 public:
-    LET();
-    explicit  LET (const std::string &input);
+    explicit  LET (Lexer &lexer, Arena &arena);
     ~LET() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+private:
+    int slot;//被赋值的变量
+    Expression *exp;//等号右边的表达式
+    PostfixExp code;//exp 的后缀形式，execute 时求值用
+    Expression *index;//赋值给数组元素时的下标，否则为 nullptr
+    PostfixExp indexCode;
 };
 
 class PRINT:public Statement {
 public:
-    PRINT();
-    explicit  PRINT (const std::string &input);
+    explicit  PRINT (Lexer &lexer, Arena &arena);
     ~PRINT() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+private:
+    Expression *exp;
+    PostfixExp code;
 };
 
 class GOTO:public Statement {
 public:
-    GOTO();
-    explicit  GOTO (const std::string &input);
+    explicit  GOTO (Lexer &lexer, Arena &arena);
     ~GOTO() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+    int getTargetLine () const override;
+private:
+    int targetLine;//跳转的目标行
 };
 
 class INPUT:public Statement {
 public:
-    INPUT();
-    explicit  INPUT (const std::string &input);
+    explicit  INPUT (Lexer &lexer, Arena &arena);
     ~INPUT() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+private:
+    int slot;//读入的变量
 };
 
 class END:public Statement {
 public:
-    END();
-    explicit  END (const std::string &input);
+    explicit  END (Lexer &lexer, Arena &arena);
     ~END() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+};
+
+class DIM:public Statement {
+public:
+    explicit  DIM (Lexer &lexer, Arena &arena);
+    ~DIM() override;
+    void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+private:
+    int slot;//数组
+    Expression *bound;//最大下标
+    PostfixExp boundCode;
 };
 
 class IF:public Statement {
 public:
-    IF();
-    explicit  IF (const std::string &input);
+    explicit  IF (Lexer &lexer, Arena &arena);
     ~IF() override;
     void execute (EvalState &state, Program &program) override;
+    void compile (Compiler &compiler) override;
+    void thread (ThreadedOp &op) const override;
+    int getTargetLine () const override;
+private:
+    Expression *lhs;//比较运算符左边的表达式
+    Expression *rhs;//比较运算符右边的表达式
+    PostfixExp lhsCode;
+    PostfixExp rhsCode;
+    char op;//比较运算符
+    int targetLine;
+    int knownResult;//两边都是常量时条件的值，否则为-1
 };
+/*
+ * Function: readInputValue
+ * Usage: Value value = readInputValue();
+ * --------------------------------------
+ * Prompts with " ? " and reads an integer from the user, asking again
+ * after INVALID NUMBER until a valid one is entered.
+ */
+
+Value readInputValue();
+
+/*
+ * Function: check
+ * Usage: if (check(op, lhs, rhs)) ...
+ * -----------------------------------
+ * Returns the outcome of the comparison lhs op rhs, where op is one
+ * of the relational operators <, > and =.
+ */
+
+bool check(char op, Value lhs, Value rhs);
+
 #endif
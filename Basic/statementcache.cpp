@@ -0,0 +1,94 @@
+/*
+ * File: statementcache.cpp
+ * ------------------------
+ * Implements the statementcache.hpp interface.
+ */
+
+#include "statementcache.hpp"
+#include "statement.hpp"
+#include "output.hpp"
+
+
+StatementCache::StatementCache(Parser parser)
+    : parser(parser), idle(0), lookups(0), hits(0) { }
+
+StatementCache::~StatementCache() {
+    for (auto &entry : entries) {
+        delete entry.second;
+    }
+}
+
+CachedStatement *StatementCache::acquire(const std::string &line) {
+    ++lookups;
+    normalize(line);
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        ++hits;
+        CachedStatement *parsed = found->second;
+        if (parsed->refs++ == 0) --idle;
+        return parsed;
+    }
+    CachedStatement *parsed = new CachedStatement;
+    try {
+        parsed->stmt = parser(line, parsed->arena);
+    } catch (...) {
+        delete parsed;
+        throw;
+    }
+    parsed->refs = 1;
+    parsed->owner = this;
+    parsed->key = key;
+    entries.emplace(key, parsed);
+    return parsed;
+}
+
+void StatementCache::release(CachedStatement *parsed) {
+    if (parsed == nullptr) return;
+    parsed->owner->unreference(parsed);
+}
+
+void StatementCache::purge() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second->refs == 0) {
+            delete it->second;
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    idle = 0;
+}
+
+void StatementCache::printStats() const {
+    long long percent = lookups == 0 ? 0 : hits * 100 / lookups;
+    std::size_t bytes = 0;
+    for (const auto &entry : entries) {
+        bytes += entry.second->arena.bytesAllocated();
+    }
+    output() << "STATEMENT CACHE: " << lookups << " LOOKUPS, "
+             << hits << " HITS (" << percent << "%), "
+             << entries.size() << " ENTRIES, " << bytes << " BYTES\n";
+}
+
+/*
+ * Implementation notes: normalize
+ * -------------------------------
+ * Builds the key for line in the key member: its tokens separated by
+ * single spaces.  Token texts never contain spaces, so two lines get
+ * the same key exactly when they have the same tokens, and therefore
+ * parse to the same statement.
+ */
+
+void StatementCache::normalize(const std::string &line) {
+    lexer.setInput(line);
+    key.clear();
+    while (lexer.hasMoreTokens()) {
+        if (!key.empty()) key += ' ';
+        key += lexer.getText(lexer.next());
+    }
+}
+
+void StatementCache::unreference(CachedStatement *parsed) {
+    if (--parsed->refs > 0) return;
+    if (++idle > IDLE_LIMIT) purge();
+}
@@ -0,0 +1,142 @@
+/*
+ * File: statementcache.hpp
+ * ------------------------
+ * This interface exports the StatementCache class, which lets program
+ * lines and immediate commands with the same statement text share a
+ * single parsed Statement.
+ */
+
+#ifndef _statementcache_h
+#define _statementcache_h
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include "arena.hpp"
+#include "lexer.hpp"
+
+class Statement;
+class StatementCache;
+
+/*
+ * Type: CachedStatement
+ * ---------------------
+ * A parsed statement together with the arena that holds it.  Each
+ * user (a program line or a running immediate command) holds one
+ * reference, taken by StatementCache::acquire and given back with
+ * StatementCache::release.  The statement must be treated as
+ * immutable, since any number of lines may be pointing at it.
+ */
+
+struct CachedStatement {
+    Statement *stmt = nullptr;
+    Arena arena;
+    int refs = 0;
+    StatementCache *owner = nullptr;
+    std::string key;
+};
+
+/*
+ * Class: StatementCache
+ * ---------------------
+ * Maps the normalized text of a statement to its parsed form.  The
+ * text is normalized to its token sequence, so lines that differ only
+ * in spacing share an entry as well.  An entry whose last reference is
+ * released stays in the cache so that a command typed again is still
+ * a hit; once more than IDLE_LIMIT such entries pile up they are all
+ * freed.
+ */
+
+class StatementCache {
+
+public:
+
+/*
+ * Type: Parser
+ * ------------
+ * The function used to parse a statement on a miss.  It allocates the
+ * statement in arena and raises an error for malformed text.
+ */
+
+    typedef Statement *(*Parser)(const std::string &line, Arena &arena);
+
+/*
+ * Constructor: StatementCache
+ * Usage: StatementCache cache(parseStatement);
+ * --------------------------------------------
+ * Creates an empty cache that parses with the given function.
+ */
+
+    explicit StatementCache(Parser parser);
+
+/*
+ * Destructor: ~StatementCache
+ * ---------------------------
+ * Frees every entry, whether or not it is still referenced.
+ */
+
+    ~StatementCache();
+
+    StatementCache(const StatementCache &) = delete;
+
+    StatementCache &operator=(const StatementCache &) = delete;
+
+/*
+ * Method: acquire
+ * Usage: CachedStatement *parsed = cache.acquire(line);
+ * -----------------------------------------------------
+ * Returns the parsed form of line with one more reference, parsing it
+ * only if no equivalent line is cached.  Parse errors propagate and
+ * leave nothing in the cache.
+ */
+
+    CachedStatement *acquire(const std::string &line);
+
+/*
+ * Method: release
+ * Usage: StatementCache::release(parsed);
+ * ---------------------------------------
+ * Gives back a reference obtained from acquire.  A null pointer is
+ * ignored.
+ */
+
+    static void release(CachedStatement *parsed);
+
+/*
+ * Method: purge
+ * Usage: cache.purge();
+ * ---------------------
+ * Frees every entry that is no longer referenced.
+ */
+
+    void purge();
+
+/*
+ * Method: printStats
+ * Usage: cache.printStats();
+ * --------------------------
+ * Prints the number of lookups, the hit rate and the size of the
+ * cache.
+ */
+
+    void printStats() const;
+
+private:
+
+    static const int IDLE_LIMIT = 1024;
+
+    Parser parser;
+    std::unordered_map<std::string, CachedStatement *> entries;
+    Lexer lexer;                /* Reused to normalize each line       */
+    std::string key;            /* Reused to build each lookup key     */
+    int idle;                   /* Entries with no references          */
+    long long lookups;
+    long long hits;
+
+    void normalize(const std::string &line);
+
+    void unreference(CachedStatement *parsed);
+
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * File: threaded.cpp
+ * ------------------
+ * Implements the threaded.hpp interface.
+ */
+
+#include <unordered_map>
+#include "threaded.hpp"
+#include "output.hpp"
+#include "profiler.hpp"
+#include "program.hpp"
+#include "sampler.hpp"
+#include "statement.hpp"
+#include "Utils/error.hpp"
+
+/*
+ * Implementation notes: ThreadedCode
+ * ----------------------------------
+ * The records are placed in line order, followed by the error record,
+ * and the array is never resized afterwards, so the pointers between
+ * records stay valid for the life of the code.
+ */
+
+ThreadedCode::ThreadedCode(Program &program) {
+    std::vector<int> numbers;
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        numbers.push_back(line);
+    }
+    ops.assign(numbers.size() + 1, ThreadedOp());
+    ThreadedOp *lineError = &ops.back();
+    lineError->handler = runLineError;
+    lineError->line = -1;
+    lineError->targetLine = -1;
+    std::unordered_map<int, ThreadedOp *> byNumber;
+    for (std::size_t i = 0; i < numbers.size(); ++i) {
+        ThreadedOp &op = ops[i];
+        op.line = numbers[i];
+        op.targetLine = -1;
+        op.next = i + 1 < numbers.size() ? &ops[i + 1] : nullptr;
+        program.getParsedStatement(numbers[i])->thread(op);
+        byNumber[numbers[i]] = &op;
+    }
+    for (std::size_t i = 0; i < numbers.size(); ++i) {
+        if (ops[i].targetLine == -1) continue;
+        auto it = byNumber.find(ops[i].targetLine);
+        ops[i].target = it == byNumber.end() ? lineError : it->second;
+    }
+}
+
+/*
+ * Implementation notes: run
+ * -------------------------
+ * As in the virtual machine, the loop is instantiated once with the
+ * sampler's line bookkeeping and once without, so the plain loop is
+ * the bare pointer chase.
+ */
+
+void ThreadedCode::run(EvalState &state) {
+    SamplerPhase phase(PHASE_EXECUTE);
+    if (Sampler::enabled) {
+        execute<true>(state);
+    } else {
+        execute<false>(state);
+    }
+}
+
+template <bool sampled>
+void ThreadedCode::execute(EvalState &state) {
+    ThreadedOp *pc = ops.size() > 1 ? &ops.front() : nullptr;
+    while (pc) {
+        if (sampled) Sampler::line = pc->line;
+        pc = pc->handler(pc, state);
+    }
+}
+
+ThreadedOp *ThreadedCode::runRem(ThreadedOp *pc, EvalState &state) {
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runLet(ThreadedOp *pc, EvalState &state) {
+    state.setValue(pc->slot, evaluate(pc->lhs, state));
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runLetElement(ThreadedOp *pc, EvalState &state) {
+    Value index = evaluate(pc->rhs, state);
+    state.setElement(pc->slot, index, evaluate(pc->lhs, state));
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runPrint(ThreadedOp *pc, EvalState &state) {
+    output() << evaluate(pc->lhs, state) << '\n';
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runInput(ThreadedOp *pc, EvalState &state) {
+    state.setValue(pc->slot, readInputValue());
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runDim(ThreadedOp *pc, EvalState &state) {
+    state.dimension(pc->slot, evaluate(pc->lhs, state));
+    return pc->next;
+}
+
+ThreadedOp *ThreadedCode::runEnd(ThreadedOp *pc, EvalState &state) {
+    return nullptr;
+}
+
+ThreadedOp *ThreadedCode::runGoto(ThreadedOp *pc, EvalState &state) {
+    return pc->target;
+}
+
+ThreadedOp *ThreadedCode::runIf(ThreadedOp *pc, EvalState &state) {
+    Value lhsValue = evaluate(pc->lhs, state);
+    Value rhsValue = evaluate(pc->rhs, state);
+    return check(pc->relation, lhsValue, rhsValue) ? pc->target : pc->next;
+}
+
+ThreadedOp *ThreadedCode::runLineError(ThreadedOp *pc, EvalState &state) {
+    error("LINE NUMBER ERROR");
+    return nullptr;
+}
@@ -0,0 +1,115 @@
+/*
+ * File: threaded.hpp
+ * ------------------
+ * This interface exports the ThreadedCode class, which runs a program
+ * as a chain of statement records, each carrying the function that
+ * executes it, instead of calling Statement::execute through the
+ * Program.
+ */
+
+#ifndef _threaded_h
+#define _threaded_h
+
+#include <vector>
+#include "evalstate.hpp"
+#include "postfix.hpp"
+
+class Program;
+struct ThreadedOp;
+
+/*
+ * Type: ThreadedHandler
+ * ---------------------
+ * Executes the statement of pc and returns the record of the statement
+ * to run next, or nullptr when the program stops.
+ */
+
+typedef ThreadedOp *(*ThreadedHandler)(ThreadedOp *pc, EvalState &state);
+
+/*
+ * Type: ThreadedOp
+ * ----------------
+ * One program line.  Statement::thread fills in the handler and the
+ * operands it uses; ThreadedCode links next and target.
+ */
+
+struct ThreadedOp {
+    ThreadedHandler handler;
+    ThreadedOp *next;       /* The following line, nullptr after the last */
+    ThreadedOp *target;     /* The line a GOTO or IF jumps to             */
+    int line;               /* BASIC line number                          */
+    int slot;               /* Variable of LET or INPUT, array of DIM     */
+    int targetLine;         /* Line number of the jump, -1 if none        */
+    char relation;          /* Comparison of IF                           */
+    PostfixExp lhs;         /* Value of LET, PRINT and DIM, left of IF    */
+    PostfixExp rhs;         /* Right side of IF, subscript of LET         */
+};
+
+/*
+ * Class: ThreadedCode
+ * -------------------
+ * The lines of a program as an array of ThreadedOp records, with
+ * every fall-through and jump resolved to a pointer when the code is
+ * built.  Running it is the loop
+ *
+ *     while (pc) pc = pc->handler(pc, state);
+ *
+ * with no virtual call and no line lookup.  A jump to a line that does
+ * not exist points at an extra record that raises LINE NUMBER ERROR,
+ * so the error still appears only when the jump is taken.  Output and
+ * errors are those of executing the statements one by one.
+ */
+
+class ThreadedCode {
+
+public:
+
+/*
+ * Constructor: ThreadedCode
+ * Usage: ThreadedCode code(program);
+ * ----------------------------------
+ * Builds the records for every line of program.  The operands refer
+ * to the parsed statements, so the program must not change while the
+ * code is in use.
+ */
+
+    explicit ThreadedCode(Program &program);
+
+/*
+ * Method: run
+ * Usage: code.run(state);
+ * -----------------------
+ * Executes the program from its first line until it stops or raises
+ * an error.
+ */
+
+    void run(EvalState &state);
+
+/*
+ * Handlers: runRem, runLet, runLetElement, runPrint, runInput,
+ *           runDim, runEnd, runGoto, runIf, runLineError
+ * ---------------------------------------------------------------
+ * The handlers that Statement::thread installs.
+ */
+
+    static ThreadedOp *runRem(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runLet(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runLetElement(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runPrint(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runInput(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runDim(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runEnd(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runGoto(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runIf(ThreadedOp *pc, EvalState &state);
+    static ThreadedOp *runLineError(ThreadedOp *pc, EvalState &state);
+
+private:
+
+    std::vector<ThreadedOp> ops;    /* The lines, then the error record */
+
+    template <bool sampled>
+    void execute(EvalState &state);
+
+};
+
+#endif
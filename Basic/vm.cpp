@@ -0,0 +1,261 @@
+/*
+ * File: vm.cpp
+ * ------------
+ * Implements the vm.hpp interface.
+ */
+
+#include <iostream>
+#include <vector>
+#include "vm.hpp"
+#include "jit.hpp"
+#include "sampler.hpp"
+#include "output.hpp"
+#include "statement.hpp"
+#include "Utils/error.hpp"
+
+
+/*
+ * Implementation notes: load, increment
+ * -------------------------------------
+ * Variable access shared by OP_LOAD and the superinstructions, which
+ * must raise the same error for an undefined variable.
+ */
+
+static inline Value load(const EvalState &state, int slot) {
+    if (!state.isDefined(slot)) error("VARIABLE NOT DEFINED");
+    return state.getValue(slot);
+}
+
+template <typename T>
+static inline void increment(EvalState &state, const FusedOperands &f) {
+    state.setValue(f.slot, Arithmetic<T>::add(T(load(state, f.slot)), T(f.step)));
+}
+
+void VirtualMachine::setJitEnabled(bool enabled) {
+    jitEnabled = enabled;
+}
+
+void VirtualMachine::run(const Bytecode &bytecode, EvalState &state) {
+    if (numericMode == NUMERIC_INT64) {
+        if (Sampler::enabled) {
+            SamplerBytecode sampling(bytecode);
+            execute<long long, false, true>(bytecode, state);
+        } else {
+            execute<long long, false, false>(bytecode, state);
+        }
+        return;
+    }
+    bool withJit = jitEnabled && BASIC_JIT_SUPPORTED;
+    if (Sampler::enabled) {
+        SamplerBytecode sampling(bytecode);
+        if (withJit) {
+            execute<int, true, true>(bytecode, state);
+        } else {
+            execute<int, false, true>(bytecode, state);
+        }
+    } else if (withJit) {
+        execute<int, true, false>(bytecode, state);
+    } else {
+        execute<int, false, false>(bytecode, state);
+    }
+}
+
+/*
+ * Implementation notes: execute
+ * -----------------------------
+ * The dispatch loop is a single switch over the opcode.  The operand
+ * stack is allocated once at the size the compiler computed, so no
+ * instruction has to check for overflow.  The stack holds Values, and
+ * the operators work in T, the type of the numeric mode; run picks
+ * the instance once per program.
+ *
+ * With the JIT, every jump that lands at or before the instruction
+ * that took it is reported as a back edge.  When the Jit returns native
+ * code for the loop, the loop runs natively on the same operand stack
+ * and variable arrays, and dispatch resumes wherever it exits.  Every
+ * slot is reserved up front so that those arrays never move while the
+ * native code holds them.  The check compiles away without the JIT.
+ *
+ * When the sampler is running, each instruction is published in
+ * Sampler::pc before it is dispatched, and native code runs in the
+ * native phase charged to the line of the loop head.
+ */
+
+template <typename T, bool withJit, bool sampled>
+void VirtualMachine::execute(const Bytecode &bytecode, EvalState &state) {
+    std::vector<Value> stack(bytecode.maxStack + 1);
+    const Instruction *code = bytecode.code.data();
+    const FusedOperands *fused = bytecode.fused.data();
+    const Value *constants = bytecode.constants.data();
+    const Instruction *pc = code;
+    Value *sp = stack.data();
+    Jit jit(bytecode);
+    JitFrame frame;
+    if (withJit) {
+        state.reserveSlots(EvalState::getSlotCount());
+        frame.values = state.getValueArray();
+        frame.defined = state.getDefinedArray();
+        frame.arrays = state.getArrayTable();
+    }
+    while (true) {
+        if (sampled) Sampler::pc = pc;
+        const Instruction &ins = *pc++;
+        switch (ins.op) {
+            case OP_PUSH:
+                *sp++ = ins.operand;
+                break;
+            case OP_PUSH_WIDE:
+                *sp++ = constants[ins.operand];
+                break;
+            case OP_LOAD:
+                *sp++ = load(state, ins.operand);
+                break;
+            case OP_STORE:
+                state.setValue(ins.operand, *--sp);
+                break;
+            case OP_DUP:
+                *sp = sp[-1];
+                ++sp;
+                break;
+            case OP_LOAD_ELEMENT:
+                sp[-1] = state.getElement(ins.operand, sp[-1]);
+                break;
+            case OP_STORE_ELEMENT:
+                sp -= 2;
+                state.setElement(ins.operand, sp[0], sp[1]);
+                break;
+            case OP_DIM:
+                state.dimension(ins.operand, *--sp);
+                break;
+            case OP_ADD:
+                --sp;
+                sp[-1] = Arithmetic<T>::add(T(sp[-1]), T(*sp));
+                break;
+            case OP_SUB:
+                --sp;
+                sp[-1] = Arithmetic<T>::subtract(T(sp[-1]), T(*sp));
+                break;
+            case OP_MUL:
+                --sp;
+                sp[-1] = Arithmetic<T>::multiply(T(sp[-1]), T(*sp));
+                break;
+            case OP_DIV:
+                --sp;
+                if (*sp == 0) error("DIVIDE BY ZERO");
+                sp[-1] = Arithmetic<T>::divide(T(sp[-1]), T(*sp));
+                break;
+            case OP_PRINT:
+                output() << *--sp << '\n';
+                break;
+            case OP_INPUT:
+                state.setValue(ins.operand, readInputValue());
+                break;
+            case OP_JUMP:
+                pc = code + ins.operand;
+                break;
+            case OP_JUMP_LT:
+                sp -= 2;
+                if (sp[0] < sp[1]) pc = code + ins.operand;
+                break;
+            case OP_JUMP_GT:
+                sp -= 2;
+                if (sp[0] > sp[1]) pc = code + ins.operand;
+                break;
+            case OP_JUMP_EQ:
+                sp -= 2;
+                if (sp[0] == sp[1]) pc = code + ins.operand;
+                break;
+            case OP_ERROR:
+                error(bytecode.messages[ins.operand]);
+                break;
+            case OP_HALT:
+                return;
+            case OP_INC:
+                increment<T>(state, fused[ins.operand]);
+                break;
+            case OP_JUMP_LT_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                if (load(state, f.lhs) < f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_JUMP_GT_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                if (load(state, f.lhs) > f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_JUMP_EQ_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                if (load(state, f.lhs) == f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_JUMP_LT_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                Value lhs = load(state, f.lhs);
+                if (lhs < load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+            case OP_JUMP_GT_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                Value lhs = load(state, f.lhs);
+                if (lhs > load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+            case OP_JUMP_EQ_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                Value lhs = load(state, f.lhs);
+                if (lhs == load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_LT_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                if (load(state, f.lhs) < f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_GT_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                if (load(state, f.lhs) > f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_EQ_CONST: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                if (load(state, f.lhs) == f.rhs) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_LT_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                Value lhs = load(state, f.lhs);
+                if (lhs < load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_GT_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                Value lhs = load(state, f.lhs);
+                if (lhs > load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+            case OP_INC_JUMP_EQ_VAR: {
+                const FusedOperands &f = fused[ins.operand];
+                increment<T>(state, f);
+                Value lhs = load(state, f.lhs);
+                if (lhs == load(state, f.rhs)) pc = code + f.target;
+                break;
+            }
+        }
+        if (withJit && pc <= &ins) {
+            JitFunction native = jit.backEdge(int(&ins - code), int(pc - code));
+            if (native != nullptr) {
+                frame.sp = sp;
+                if (sampled) Sampler::pc = pc;
+                SamplerPhase phase(PHASE_NATIVE);
+                native(&frame);
+                sp = frame.sp;
+                pc = code + frame.exitOffset;
+            }
+        }
+    }
+}
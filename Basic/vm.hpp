@@ -0,0 +1,56 @@
+/*
+ * File: vm.hpp
+ * ------------
+ * This interface exports the VirtualMachine class, which runs a
+ * program that the Compiler has turned into bytecode.
+ */
+
+#ifndef _vm_h
+#define _vm_h
+
+#include "bytecode.hpp"
+#include "evalstate.hpp"
+
+/*
+ * Class: VirtualMachine
+ * ---------------------
+ * A stack machine for the instructions in bytecode.hpp.  Running a
+ * program gives the same output and raises the same errors, at the
+ * same points, as executing its statements one by one.
+ */
+
+class VirtualMachine {
+
+public:
+
+/*
+ * Method: run
+ * Usage: vm.run(bytecode, state);
+ * -------------------------------
+ * Executes the bytecode from its first instruction until it halts
+ * or raises an error.
+ */
+
+    void run(const Bytecode &bytecode, EvalState &state);
+
+/*
+ * Method: setJitEnabled
+ * Usage: vm.setJitEnabled(true);
+ * ------------------------------
+ * Lets run translate hot loops into native code (see jit.hpp).  This
+ * is off by default and has no effect where the JIT is unsupported
+ * or in the 64-bit numeric mode, for which it generates no code.
+ */
+
+    void setJitEnabled(bool enabled);
+
+private:
+
+    bool jitEnabled = false;
+
+    template <typename T, bool withJit, bool sampled>
+    void execute(const Bytecode &bytecode, EvalState &state);
+
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * File: alloccount.cpp
+ * --------------------
+ * A library for LD_PRELOAD that counts the calls to malloc, calloc and
+ * realloc in the process it is loaded into and prints
+ * "ALLOCATIONS <count>" to stderr when the process exits.  operator
+ * new in libstdc++ allocates through malloc, and Arena::addChunk calls
+ * malloc directly, so both the allocations made through new and the
+ * arena chunks that hold parsed statements are counted.  The calls are
+ * forwarded to glibc's own entry points, which free accepts as usual.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+
+}
+
+static unsigned long long allocations = 0;
+
+extern "C" void *malloc(std::size_t size) {
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(std::size_t count, std::size_t size) {
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *p, std::size_t size) {
+    ++allocations;
+    return __libc_realloc(p, size);
+}
+
+__attribute__((destructor)) static void reportAllocations() {
+    std::fprintf(stderr, "ALLOCATIONS %llu\n", allocations);
+}
@@ -0,0 +1,24 @@
+10 REM Sieve of Eratosthenes over an array of 200000 flags, repeated
+20 DIM f(200000)
+30 LET k = 0
+40 LET i = 2
+50 LET f(i) = 0
+60 LET i = i + 1
+70 IF i < 200001 THEN 50
+80 LET c = 0
+90 LET n = 2
+100 IF f(n) = 1 THEN 170
+110 LET c = c + 1
+120 IF n > 447 THEN 170
+130 LET m = n * n
+140 LET f(m) = 1
+150 LET m = m + n
+160 IF m < 200001 THEN 140
+170 LET n = n + 1
+180 IF n < 200001 THEN 100
+190 LET k = k + 1
+200 IF k < 10 THEN 40
+210 PRINT c
+220 END
+RUN
+QUIT
@@ -0,0 +1,16 @@
+10 REM Fibonacci numbers modulo 1000000, recomputed many times
+20 LET k = 0
+30 LET a = 0
+40 LET b = 1
+50 LET i = 0
+60 LET t = a + b
+70 LET a = b
+80 LET b = t - t / 1000000 * 1000000
+90 LET i = i + 1
+100 IF i < 1000 THEN 60
+110 LET k = k + 1
+120 IF k < 2000 THEN 30
+130 PRINT b
+140 END
+RUN
+QUIT
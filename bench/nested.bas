@@ -0,0 +1,13 @@
+10 REM Two nested counting loops
+20 LET s = 0
+30 LET i = 0
+40 LET j = 0
+50 LET s = s + i * j - s / 3
+60 LET j = j + 1
+70 IF j < 1000 THEN 50
+80 LET i = i + 1
+90 IF i < 2000 THEN 40
+100 PRINT s
+110 END
+RUN
+QUIT
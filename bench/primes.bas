@@ -0,0 +1,15 @@
+10 REM Count the primes below 200000 by trial division, all control flow by GOTO
+20 LET c = 0
+30 LET n = 2
+40 LET d = 2
+50 IF d * d > n THEN 100
+60 IF n - n / d * d = 0 THEN 110
+70 LET d = d + 1
+80 GOTO 50
+100 LET c = c + 1
+110 LET n = n + 1
+120 IF n < 200000 THEN 40
+130 PRINT c
+140 END
+RUN
+QUIT
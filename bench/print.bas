@@ -0,0 +1,8 @@
+10 REM Output bound: print half a million numbers
+20 LET i = 0
+30 PRINT i * 7 - 3
+40 LET i = i + 1
+50 IF i < 500000 THEN 30
+60 END
+RUN
+QUIT
@@ -0,0 +1,185 @@
+/*
+ * File: runner.cpp
+ * ----------------
+ * Runs the BASIC workloads in bench/ against an interpreter executable
+ * and reports, for each one, the median wall time over several runs,
+ * the statements executed per second and the number of allocations.
+ *
+ * Usage: bench_runner <code> <bench_dir> <alloc_lib> [-n runs] [-a arg]
+ *
+ * Every workload file *.bas is fed to the interpreter as stdin, with
+ * its output discarded.  One more workload, load, is generated in the
+ * current directory: a 100000-line program that is entered and run
+ * once, which measures the cost of reading and parsing lines.
+ *
+ * Besides the timed runs each workload is run twice more:
+ *
+ *   - with --tree-walk --stats, which makes the interpreter print how
+ *     many statements it executed.  Statements per second is that
+ *     count over the median time of the timed runs.
+ *   - with the library alloc_lib preloaded, which counts the calls to
+ *     malloc, calloc and realloc and prints the total at exit.
+ *
+ * Extra arguments given with -a are passed to the interpreter on the
+ * timed and counted runs, e.g. -a --jit.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+const int loadLines = 100000;
+
+struct Result {
+    double seconds = 0;
+    string errors;          // everything the interpreter wrote to stderr
+    bool ok = false;
+};
+
+/*
+ * Function: runOnce
+ * -----------------
+ * Runs the interpreter with the workload as stdin and stdout discarded,
+ * optionally with a library preloaded, and returns its wall time and
+ * stderr.
+ */
+
+Result runOnce(const string &code, const vector<string> &args, const string &workload, const string &preload) {
+    Result result;
+    int in = open(workload.c_str(), O_RDONLY);
+    int fds[2];
+    if (in < 0 || pipe(fds) != 0) {
+        cerr << "cannot open " << workload << endl;
+        exit(1);
+    }
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(in, 0);
+        dup2(null, 1);
+        dup2(fds[1], 2);
+        close(fds[0]);
+        if (preload.size()) setenv("LD_PRELOAD", preload.c_str(), 1);
+        vector<char *> argv;
+        argv.push_back(const_cast<char *>(code.c_str()));
+        for (const string &arg : args) argv.push_back(const_cast<char *>(arg.c_str()));
+        argv.push_back(nullptr);
+        execv(code.c_str(), argv.data());
+        _exit(127);
+    }
+    close(in);
+    close(fds[1]);
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) result.errors.append(buffer, n);
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return result;
+}
+
+/*
+ * Function: readCounter
+ * ---------------------
+ * Returns the number after "name " in the stderr of a run, or -1.
+ */
+
+long long readCounter(const string &errors, const string &name) {
+    size_t at = errors.find(name + " ");
+    if (at == string::npos) return -1;
+    return atoll(errors.c_str() + at + name.size() + 1);
+}
+
+string generateLoadWorkload() {
+    string path = "load.bas";
+    ofstream file(path);
+    file << "5 LET x0 = 0\n";
+    for (int i = 1; i <= loadLines; i++) {
+        file << i * 10 << " LET x" << i % 100 << " = x" << (i + 99) % 100 << " + " << i % 7 << "\n";
+    }
+    file << "RUN\nQUIT\n";
+    return path;
+}
+
+vector<string> findWorkloads(const string &dir) {
+    vector<string> workloads;
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        cerr << "cannot open " << dir << endl;
+        exit(1);
+    }
+    while (dirent *entry = readdir(d)) {
+        string name = entry->d_name;
+        if (name.size() > 4 && name.substr(name.size() - 4) == ".bas") workloads.push_back(dir + "/" + name);
+    }
+    closedir(d);
+    sort(workloads.begin(), workloads.end());
+    return workloads;
+}
+
+string workloadName(const string &path) {
+    size_t slash = path.rfind('/');
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    return name.substr(0, name.size() - 4);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cerr << "usage: " << argv[0] << " <code> <bench_dir> <alloc_lib> [-n runs] [-a arg]" << endl;
+        return 1;
+    }
+    string code = argv[1], dir = argv[2], allocLib = argv[3];
+    int runs = 5;
+    vector<string> args;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "-n") runs = max(1, atoi(argv[i + 1]));
+        else if (string(argv[i]) == "-a") args.push_back(argv[i + 1]);
+    }
+    vector<string> workloads = findWorkloads(dir);
+    workloads.push_back(generateLoadWorkload());
+    // Only the tree-walk loop counts statements, so the count comes from
+    // a separate --tree-walk run even when -a selects another engine.
+    // --tree-walk overrides --threaded and the VM options in args.  This
+    // is only valid because every engine executes exactly the same
+    // statements for a given program, so the count does not depend on
+    // the engine that was timed.
+    vector<string> countArgs = args;
+    countArgs.push_back("--tree-walk");
+    countArgs.push_back("--stats");
+    cout << left << setw(12) << "workload" << right << setw(12) << "median ms" << setw(12) << "min ms"
+         << setw(12) << "max ms" << setw(16) << "statements/s" << setw(14) << "allocations" << endl;
+    bool failed = false;
+    for (const string &workload : workloads) {
+        vector<double> times;
+        for (int i = 0; i < runs; i++) {
+            Result result = runOnce(code, args, workload, "");
+            failed |= !result.ok;
+            times.push_back(result.seconds);
+        }
+        sort(times.begin(), times.end());
+        double median = times[times.size() / 2];
+        long long statements = readCounter(runOnce(code, countArgs, workload, "").errors, "STATEMENTS");
+        long long allocations = readCounter(runOnce(code, args, workload, allocLib).errors, "ALLOCATIONS");
+        cout << left << setw(12) << workloadName(workload) << right << fixed << setprecision(1)
+             << setw(12) << median * 1000 << setw(12) << times.front() * 1000 << setw(12) << times.back() * 1000
+             << setprecision(0) << setw(16) << (statements < 0 ? 0.0 : statements / median)
+             << setw(14) << allocations << endl;
+    }
+    if (failed) cerr << "some runs did not exit normally" << endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+10 REM Many variables: a chain of 200 distinct names updated in a loop
+20 LET k = 0
+30 LET v0 = 1
+40 LET v1 = v0 + 1
+50 LET v2 = v1 + 2
+60 LET v3 = v2 + 3
+70 LET v4 = v3 + 4
+80 LET v5 = v4 + 5
+90 LET v6 = v5 + 6
+100 LET v7 = v6 + 0
+110 LET v8 = v7 + 1
+120 LET v9 = v8 + 2
+130 LET v10 = v9 + 3
+140 LET v11 = v10 + 4
+150 LET v12 = v11 + 5
+160 LET v13 = v12 + 6
+170 LET v14 = v13 + 0
+180 LET v15 = v14 + 1
+190 LET v16 = v15 + 2
+200 LET v17 = v16 + 3
+210 LET v18 = v17 + 4
+220 LET v19 = v18 + 5
+230 LET v20 = v19 + 6
+240 LET v21 = v20 + 0
+250 LET v22 = v21 + 1
+260 LET v23 = v22 + 2
+270 LET v24 = v23 + 3
+280 LET v25 = v24 + 4
+290 LET v26 = v25 + 5
+300 LET v27 = v26 + 6
+310 LET v28 = v27 + 0
+320 LET v29 = v28 + 1
+330 LET v30 = v29 + 2
+340 LET v31 = v30 + 3
+350 LET v32 = v31 + 4
+360 LET v33 = v32 + 5
+370 LET v34 = v33 + 6
+380 LET v35 = v34 + 0
+390 LET v36 = v35 + 1
+400 LET v37 = v36 + 2
+410 LET v38 = v37 + 3
+420 LET v39 = v38 + 4
+430 LET v40 = v39 + 5
+440 LET v41 = v40 + 6
+450 LET v42 = v41 + 0
+460 LET v43 = v42 + 1
+470 LET v44 = v43 + 2
+480 LET v45 = v44 + 3
+490 LET v46 = v45 + 4
+500 LET v47 = v46 + 5
+510 LET v48 = v47 + 6
+520 LET v49 = v48 + 0
+530 LET v50 = v49 + 1
+540 LET v51 = v50 + 2
+550 LET v52 = v51 + 3
+560 LET v53 = v52 + 4
+570 LET v54 = v53 + 5
+580 LET v55 = v54 + 6
+590 LET v56 = v55 + 0
+600 LET v57 = v56 + 1
+610 LET v58 = v57 + 2
+620 LET v59 = v58 + 3
+630 LET v60 = v59 + 4
+640 LET v61 = v60 + 5
+650 LET v62 = v61 + 6
+660 LET v63 = v62 + 0
+670 LET v64 = v63 + 1
+680 LET v65 = v64 + 2
+690 LET v66 = v65 + 3
+700 LET v67 = v66 + 4
+710 LET v68 = v67 + 5
+720 LET v69 = v68 + 6
+730 LET v70 = v69 + 0
+740 LET v71 = v70 + 1
+750 LET v72 = v71 + 2
+760 LET v73 = v72 + 3
+770 LET v74 = v73 + 4
+780 LET v75 = v74 + 5
+790 LET v76 = v75 + 6
+800 LET v77 = v76 + 0
+810 LET v78 = v77 + 1
+820 LET v79 = v78 + 2
+830 LET v80 = v79 + 3
+840 LET v81 = v80 + 4
+850 LET v82 = v81 + 5
+860 LET v83 = v82 + 6
+870 LET v84 = v83 + 0
+880 LET v85 = v84 + 1
+890 LET v86 = v85 + 2
+900 LET v87 = v86 + 3
+910 LET v88 = v87 + 4
+920 LET v89 = v88 + 5
+930 LET v90 = v89 + 6
+940 LET v91 = v90 + 0
+950 LET v92 = v91 + 1
+960 LET v93 = v92 + 2
+970 LET v94 = v93 + 3
+980 LET v95 = v94 + 4
+990 LET v96 = v95 + 5
+1000 LET v97 = v96 + 6
+1010 LET v98 = v97 + 0
+1020 LET v99 = v98 + 1
+1030 LET v100 = v99 + 2
+1040 LET v101 = v100 + 3
+1050 LET v102 = v101 + 4
+1060 LET v103 = v102 + 5
+1070 LET v104 = v103 + 6
+1080 LET v105 = v104 + 0
+1090 LET v106 = v105 + 1
+1100 LET v107 = v106 + 2
+1110 LET v108 = v107 + 3
+1120 LET v109 = v108 + 4
+1130 LET v110 = v109 + 5
+1140 LET v111 = v110 + 6
+1150 LET v112 = v111 + 0
+1160 LET v113 = v112 + 1
+1170 LET v114 = v113 + 2
+1180 LET v115 = v114 + 3
+1190 LET v116 = v115 + 4
+1200 LET v117 = v116 + 5
+1210 LET v118 = v117 + 6
+1220 LET v119 = v118 + 0
+1230 LET v120 = v119 + 1
+1240 LET v121 = v120 + 2
+1250 LET v122 = v121 + 3
+1260 LET v123 = v122 + 4
+1270 LET v124 = v123 + 5
+1280 LET v125 = v124 + 6
+1290 LET v126 = v125 + 0
+1300 LET v127 = v126 + 1
+1310 LET v128 = v127 + 2
+1320 LET v129 = v128 + 3
+1330 LET v130 = v129 + 4
+1340 LET v131 = v130 + 5
+1350 LET v132 = v131 + 6
+1360 LET v133 = v132 + 0
+1370 LET v134 = v133 + 1
+1380 LET v135 = v134 + 2
+1390 LET v136 = v135 + 3
+1400 LET v137 = v136 + 4
+1410 LET v138 = v137 + 5
+1420 LET v139 = v138 + 6
+1430 LET v140 = v139 + 0
+1440 LET v141 = v140 + 1
+1450 LET v142 = v141 + 2
+1460 LET v143 = v142 + 3
+1470 LET v144 = v143 + 4
+1480 LET v145 = v144 + 5
+1490 LET v146 = v145 + 6
+1500 LET v147 = v146 + 0
+1510 LET v148 = v147 + 1
+1520 LET v149 = v148 + 2
+1530 LET v150 = v149 + 3
+1540 LET v151 = v150 + 4
+1550 LET v152 = v151 + 5
+1560 LET v153 = v152 + 6
+1570 LET v154 = v153 + 0
+1580 LET v155 = v154 + 1
+1590 LET v156 = v155 + 2
+1600 LET v157 = v156 + 3
+1610 LET v158 = v157 + 4
+1620 LET v159 = v158 + 5
+1630 LET v160 = v159 + 6
+1640 LET v161 = v160 + 0
+1650 LET v162 = v161 + 1
+1660 LET v163 = v162 + 2
+1670 LET v164 = v163 + 3
+1680 LET v165 = v164 + 4
+1690 LET v166 = v165 + 5
+1700 LET v167 = v166 + 6
+1710 LET v168 = v167 + 0
+1720 LET v169 = v168 + 1
+1730 LET v170 = v169 + 2
+1740 LET v171 = v170 + 3
+1750 LET v172 = v171 + 4
+1760 LET v173 = v172 + 5
+1770 LET v174 = v173 + 6
+1780 LET v175 = v174 + 0
+1790 LET v176 = v175 + 1
+1800 LET v177 = v176 + 2
+1810 LET v178 = v177 + 3
+1820 LET v179 = v178 + 4
+1830 LET v180 = v179 + 5
+1840 LET v181 = v180 + 6
+1850 LET v182 = v181 + 0
+1860 LET v183 = v182 + 1
+1870 LET v184 = v183 + 2
+1880 LET v185 = v184 + 3
+1890 LET v186 = v185 + 4
+1900 LET v187 = v186 + 5
+1910 LET v188 = v187 + 6
+1920 LET v189 = v188 + 0
+1930 LET v190 = v189 + 1
+1940 LET v191 = v190 + 2
+1950 LET v192 = v191 + 3
+1960 LET v193 = v192 + 4
+1970 LET v194 = v193 + 5
+1980 LET v195 = v194 + 6
+1990 LET v196 = v195 + 0
+2000 LET v197 = v196 + 1
+2010 LET v198 = v197 + 2
+2020 LET v199 = v198 + 3
+2030 LET v0 = v199 - v0 * 3
+2040 LET k = k + 1
+2050 IF k < 50000 THEN 40
+2060 PRINT v0
+2070 END
+RUN
+QUIT
@@ -1,6 +1,16 @@
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
 #include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
 #include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -37,19 +47,24 @@ string standerBasic = "";
 string traceFile = "";
 int runTraces = traceCount, currentTrace = 0;
 bool silent = false, firstFail = false, hideError = false, useColor = true;
+bool parallel = false;
+int jobCount = 0;
 
 int correct = 0, wrong = 0, total = 0;
 
 void usage(const char *progname) {
     cout
-            << progname << " [-h] [-e <your_exec>] [-s <stander_exec>] [-t <trace_file>] [-f] [-m] [-q]" << endl
+            << progname << " [-h] [-e <your_exec>] [-s <stander_exec>] [-t <trace_file>] [-f] [-m] [-q] [-p] [-j <jobs>]"
+            << endl
             << "    -h  Show this message and quit" << endl
             << "    -e  Specify your executable file, default value: " << defaultStudentBasic << endl
             << "    -s  Specify demo executable file, default value: " << defaultStanderBasic << endl
             << "    -t  Run specified trace file" << endl
             << "    -f  Stop at first failed test" << endl
             << "    -m  Hide error message" << endl
-            << "    -q  Show final score only, cannot use with -t or -f, include -m" << endl;
+            << "    -q  Show final score only, cannot use with -t or -f, include -m" << endl
+            << "    -p  Run traces in parallel and show time and peak memory of each run, skips the valgrind check" << endl
+            << "    -j  Number of traces run at once with -p, default value: number of cores, include -p" << endl;
     exit(1);
 }
 
@@ -61,7 +76,7 @@ string color(string ce) {
 void parseArguments(int argc, char **argv) {
     int c;
     opterr = 0;
-    while ((c = getopt(argc, argv, "e:s:t:fmqch")) != -1) {
+    while ((c = getopt(argc, argv, "e:s:t:fmqpj:ch")) != -1) {
         switch (c) {
             case 'e':
                 if (studentBasic.size()) usage(argv[0]);
@@ -87,6 +102,15 @@ void parseArguments(int argc, char **argv) {
                 if (silent) usage(argv[0]);
                 silent = true;
                 break;
+            case 'p':
+                parallel = true;
+                break;
+            case 'j':
+                if (jobCount) usage(argv[0]);
+                jobCount = atoi(optarg);
+                if (jobCount <= 0) usage(argv[0]);
+                parallel = true;
+                break;
             case 'h':
                 usage(argv[0]);
                 break;
@@ -99,6 +123,7 @@ void parseArguments(int argc, char **argv) {
     if (silent) hideError = true;
     if (studentBasic.size() == 0) studentBasic = defaultStudentBasic;
     if (standerBasic.size() == 0) standerBasic = defaultStanderBasic;
+    if (parallel && jobCount == 0) jobCount = max(1L, sysconf(_SC_NPROCESSORS_ONLN));
 }
 
 void clearTempFiles() {
@@ -167,6 +192,169 @@ void runTest(const string currentTrace) {
     }
 }
 
+/*
+ * Parallel mode (-p)
+ * ------------------
+ * Each trace is run through both executables as direct child processes
+ * instead of shell pipelines: stdin is the trace file itself and stdout
+ * a pipe that is read into memory, so the outputs are compared without
+ * temp files or diff.  Up to jobCount children run at once and their
+ * pipes are multiplexed with poll.  wait4 gives the peak RSS of every
+ * child.  The results are reported in trace order once all have run.
+ */
+
+const double timeLimit = 1.0;
+
+struct Run {
+    string output;
+    bool ok = false;        // exited with status 0 within timeLimit
+    double millis = 0;
+    long peakRssKb = 0;
+};
+
+struct TraceResult {
+    string trace;
+    Run ans, out;
+};
+
+struct Job {
+    const string *exec;
+    const string *trace;
+    Run *run;
+};
+
+struct Child {
+    pid_t pid;
+    int fd;
+    Run *run;
+    chrono::steady_clock::time_point start;
+    bool killed;
+};
+
+bool startChild(const Job &job, Child &child) {
+    int in = open(job.trace->c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        close(in);
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(in, 0);
+        dup2(fds[1], 1);
+        dup2(null, 2);
+        execlp(job.exec->c_str(), job.exec->c_str(), (char *) nullptr);
+        _exit(127);
+    }
+    close(in);
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return false;
+    }
+    child = {pid, fds[0], job.run, chrono::steady_clock::now(), false};
+    return true;
+}
+
+void finishChild(const Child &child) {
+    int status = 0;
+    struct rusage usage = {};
+    close(child.fd);
+    wait4(child.pid, &status, 0, &usage);
+    child.run->millis = chrono::duration<double, milli>(chrono::steady_clock::now() - child.start).count();
+    child.run->peakRssKb = usage.ru_maxrss;
+    child.run->ok = !child.killed && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void runJobs(const vector<Job> &jobs) {
+    vector<Child> running;
+    size_t next = 0;
+    char buffer[65536];
+    while (next < jobs.size() || !running.empty()) {
+        while (next < jobs.size() && (int) running.size() < jobCount) {
+            Child child;
+            if (startChild(jobs[next], child)) running.push_back(child);
+            next++;
+        }
+        if (running.empty()) continue;
+        auto now = chrono::steady_clock::now();
+        int wait = 1000;
+        vector<pollfd> fds;
+        for (Child &child : running) {
+            double left = timeLimit * 1000 - chrono::duration<double, milli>(now - child.start).count();
+            if (!child.killed && left <= 0) {
+                kill(child.pid, SIGKILL);
+                child.killed = true;
+            }
+            if (!child.killed) wait = min(wait, (int) left + 1);
+            fds.push_back({child.fd, POLLIN, 0});
+        }
+        poll(fds.data(), fds.size(), wait);
+        for (size_t i = fds.size(); i-- > 0;) {
+            if (fds[i].revents == 0) continue;
+            ssize_t n = read(fds[i].fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                running[i].run->output.append(buffer, n);
+            } else {
+                finishChild(running[i]);
+                running.erase(running.begin() + i);
+            }
+        }
+    }
+}
+
+void printRun(const char *name, const Run &run) {
+    cout << "  " << name << fixed << setprecision(1) << setw(8) << run.millis << " ms" << setw(8) << run.peakRssKb
+         << " KB";
+}
+
+void reportParallel(const TraceResult &result) {
+    int error = !result.ans.ok ? 1 : !result.out.ok ? 2 : result.ans.output != result.out.output ? 4 : 0;
+    total++;
+    if (!error) correct++;
+    else wrong++;
+    if (silent) return;
+    cout << "Trace \"" << result.trace << "\" ... ";
+    if (!error) cout << color("\x1b[32;1m") << "Pass" << color("\x1b[0m");
+    else cout << color("\x1b[31;1m") << "Fail" << color("\x1b[0m");
+    printRun("demo", result.ans);
+    printRun("yours", result.out);
+    cout << endl;
+    if (!error || hideError) return;
+    ifstream file(result.trace);
+    cout << "Trace file: " << endl << color("\x1b[35m") << file.rdbuf() << color("\x1b[0m") << endl;
+    if (error == 1)
+        cout << color("\x1b[31m") << "Error occurred while running demo program" << color("\x1b[0m") << endl;
+    if (error == 2)
+        cout << color("\x1b[31m") << "Error occurred while running your program" << color("\x1b[0m") << endl;
+    if (error == 4) {
+        cout << "Demo output: " << endl << color("\x1b[36m") << result.ans.output << color("\x1b[0m") << endl;
+        cout << "Your output: " << endl << color("\x1b[33m") << result.out.output << color("\x1b[0m") << endl;
+    }
+}
+
+void runParallel(const vector<string> &traceList) {
+    auto start = chrono::steady_clock::now();
+    vector<TraceResult> results(traceList.size());
+    vector<Job> jobs;
+    for (size_t i = 0; i < traceList.size(); i++) {
+        results[i].trace = traceList[i];
+        jobs.push_back({&standerBasic, &results[i].trace, &results[i].ans});
+        jobs.push_back({&studentBasic, &results[i].trace, &results[i].out});
+    }
+    runJobs(jobs);
+    for (const TraceResult &result : results) {
+        reportParallel(result);
+        if (firstFail && wrong) break;
+    }
+    if (!silent)
+        cout << traceList.size() << " trace(s) run in " << fixed << setprecision(2)
+             << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s with " << jobCount
+             << " job(s)." << endl;
+}
+
 void showScore() {
     int score = correct / 5 * 5;
     if (!silent)
@@ -182,9 +370,14 @@ int main(int argc, char **argv) {
         /**************************************************************
          if you modify the structure of the files, you should modify the file paths here.
          **************************************************************/
-        system("g++ -std=c++17 -o testcode Basic/Basic.cpp Basic/evalstate.cpp Basic/exp.cpp Basic/parser.cpp Basic/program.cpp Basic/statement.cpp Basic/Utils/error.cpp Basic/Utils/tokenScanner.cpp Basic/Utils/strlib.cpp");
+        system("g++ -std=c++17 -o testcode Basic/Basic.cpp Basic/arena.cpp Basic/compiler.cpp Basic/evalstate.cpp Basic/exp.cpp Basic/input.cpp Basic/jit.cpp Basic/lexer.cpp Basic/numeric.cpp Basic/optimizer.cpp Basic/output.cpp Basic/parser.cpp Basic/postfix.cpp Basic/profiler.cpp Basic/program.cpp Basic/sampler.cpp Basic/statement.cpp Basic/statementcache.cpp Basic/threaded.cpp Basic/vm.cpp Basic/Utils/error.cpp Basic/Utils/tokenScanner.cpp Basic/Utils/strlib.cpp");
         system("chmod a+rwx Basic-Demo-64bit");
-        if (traceFile.size()) runTest(traceFile);
+        if (parallel) {
+            vector<string> traceList;
+            if (traceFile.size()) traceList.push_back(traceFile);
+            else for (int i = 0; i < traceCount; i++) traceList.push_back(traceFolder + traces[i]);
+            runParallel(traceList);
+        } else if (traceFile.size()) runTest(traceFile);
         else {
             int i = 0;
             for (; i < traceCount; i++) runTest(traceFolder + traces[i]);